@@ -1,162 +1,464 @@
 #include "ai.h"
+#include "allocstats.h"
+#include "evalparams.h"
+#include "pawns.h"
+#include "profile.h"
+#include "see.h"
+#include "tablebase.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <limits>
+#include <optional>
+#include <thread>
 
-// --- Piece-Square Tables (с точки зрения белых, row 0 = rank 1) ---
-
-static const int PAWN_TABLE[8][8] = {
-    {  0,  0,  0,  0,  0,  0,  0,  0},
-    {  5, 10, 10,-20,-20, 10, 10,  5},
-    {  5, -5,-10,  0,  0,-10, -5,  5},
-    {  0,  0,  0, 20, 20,  0,  0,  0},
-    {  5,  5, 10, 25, 25, 10,  5,  5},
-    { 10, 10, 20, 30, 30, 20, 10, 10},
-    { 50, 50, 50, 50, 50, 50, 50, 50},
-    {  0,  0,  0,  0,  0,  0,  0,  0}
-};
+// Пешечная хеш-таблица своя у каждого потока — без синхронизации
+static thread_local PawnHashTable pawnTable;
 
-static const int KNIGHT_TABLE[8][8] = {
-    {-50,-40,-30,-30,-30,-30,-40,-50},
-    {-40,-20,  0,  5,  5,  0,-20,-40},
-    {-30,  5, 10, 15, 15, 10,  5,-30},
-    {-30,  0, 15, 20, 20, 15,  0,-30},
-    {-30,  5, 15, 20, 20, 15,  5,-30},
-    {-30,  0, 10, 15, 15, 10,  0,-30},
-    {-40,-20,  0,  0,  0,  0,-20,-40},
-    {-50,-40,-30,-30,-30,-30,-40,-50}
-};
+static std::atomic<EvalBackend> evalBackend{EvalBackend::Pst};
 
-static const int BISHOP_TABLE[8][8] = {
-    {-20,-10,-10,-10,-10,-10,-10,-20},
-    {-10,  5,  0,  0,  0,  0,  5,-10},
-    {-10, 10, 10, 10, 10, 10, 10,-10},
-    {-10,  0, 10, 10, 10, 10,  0,-10},
-    {-10,  5,  5, 10, 10,  5,  5,-10},
-    {-10,  0,  5, 10, 10,  5,  0,-10},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-20,-10,-10,-10,-10,-10,-10,-20}
-};
+void setEvalBackend(EvalBackend backend) {
+    evalBackend.store(backend, std::memory_order_relaxed);
+}
 
-static const int ROOK_TABLE[8][8] = {
-    {  0,  0,  0,  5,  5,  0,  0,  0},
-    { -5,  0,  0,  0,  0,  0,  0, -5},
-    { -5,  0,  0,  0,  0,  0,  0, -5},
-    { -5,  0,  0,  0,  0,  0,  0, -5},
-    { -5,  0,  0,  0,  0,  0,  0, -5},
-    { -5,  0,  0,  0,  0,  0,  0, -5},
-    {  5, 10, 10, 10, 10, 10, 10,  5},
-    {  0,  0,  0,  0,  0,  0,  0,  0}
-};
+EvalBackend getEvalBackend() {
+    return evalBackend.load(std::memory_order_relaxed);
+}
 
-static int getPieceValue(PieceType type) {
-    switch (type) {
-        case PieceType::Pawn:   return 100;
-        case PieceType::Knight: return 320;
-        case PieceType::Bishop: return 330;
-        case PieceType::Rook:   return 500;
-        case PieceType::Queen:  return 900;
-        case PieceType::King:   return 20000;
+int evaluateBoard(const Board& board) {
+    return evaluateBoard(board, getEvalBackend());
+}
+
+int evaluateBoard(const Board& board, EvalBackend backend) {
+    PROFILE_SCOPE(EvaluateBoard);
+    if (backend == EvalBackend::Nnue && isNnueLoaded()) {
+        return nnueForward(board.getNnueAccumulator());
     }
-    return 0;
+
+    // Материал и piece-square таблицы уже накоплены в Board инкрементально
+    Score score = board.getPsqtScore() + pawnTable.probe(board).score;
+    return taper(score, board.getPhase());
 }
 
-static int getPieceSquareBonus(const Piece* piece, int row, int col) {
-    int r = (piece->color == Color::White) ? row : (7 - row);
-    int c = col;
+// Оценка выигрыша по таблицам: ниже любого мата, но выше любой позиционной оценки
+static const int TABLEBASE_WIN_SCORE = 50000;
 
-    switch (piece->type) {
-        case PieceType::Pawn:   return PAWN_TABLE[r][c];
-        case PieceType::Knight: return KNIGHT_TABLE[r][c];
-        case PieceType::Bishop: return BISHOP_TABLE[r][c];
-        case PieceType::Rook:   return ROOK_TABLE[r][c];
-        default: return 0;
+// Оценка WDL с точки зрения белых; более близкий к корню выигрыш лучше
+static int tablebaseScore(WdlScore wdl, int depth, Color side) {
+    int score = 0;
+    switch (wdl) {
+        case WdlScore::Win:         score = TABLEBASE_WIN_SCORE + depth; break;
+        case WdlScore::CursedWin:   score = 1; break;
+        case WdlScore::Draw:        score = 0; break;
+        case WdlScore::BlessedLoss: score = -1; break;
+        case WdlScore::Loss:        score = -TABLEBASE_WIN_SCORE - depth; break;
     }
+    return side == Color::White ? score : -score;
 }
 
-int evaluateBoard(const Board& board) {
-    int score = 0;
+// WDL-проба внутри поиска: только сразу после взятия или хода пешкой
+// (иначе позиция уже пробовалась выше) и на достаточной глубине
+static std::optional<int> probeTablebaseInSearch(const Board& board, int depth, Color side) {
+    if (board.getHalfmoveClock() != 0 || !canProbeTablebases(board)) return std::nullopt;
+
+    const TablebaseConfig& config = getTablebaseConfig();
+    int cardinality = std::min(config.pieceLimit, tablebaseMaxPieces());
+    if (board.getPieceCount() == cardinality && depth < config.probeDepth) return std::nullopt;
+
+    auto wdl = probeWdl(board, side);
+    if (!wdl) return std::nullopt;
+    return tablebaseScore(*wdl, depth, side);
+}
+
+// --- Minimax с alpha-beta отсечением ---
+
+// Переставить ход в начало списка, сохранив порядок остальных
+static void moveToFront(std::vector<Move>& moves, const Move& move) {
+    auto it = std::find(moves.begin(), moves.end(), move);
+    if (it != moves.end()) std::rotate(moves.begin(), it, it + 1);
+}
+
+// Мат на расстоянии ply от корня оценивается в ±(MATE_SCORE - ply): более
+// близкий мат лучше. Все матовые оценки не меньше MATE_BOUND по модулю.
+static const int MATE_SCORE = 100000 + 128;
+static const int MATE_BOUND = 100000;
+
+// Матовые оценки в таблице хранятся от текущего узла, а не от корня
+static int scoreToTt(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTt(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+// Сингулярное продление: с какой остаточной глубины и с каким запасом (на ход глубины)
+static const int SINGULAR_MIN_DEPTH = 4;
+static const int SINGULAR_MARGIN = 15;
+
+// Взятие (включая взятие на проходе)
+static bool isCapture(const Board& board, const Move& move) {
+    if (board.getPiece(move.to)) return true;
+    const Piece* piece = board.getPiece(move.from);
+    return piece && piece->type == PieceType::Pawn && move.from.col != move.to.col;
+}
+
+// Сортировка: выгодные и равные взятия по убыванию SEE, затем тихие ходы,
+// затем проигрывающие взятия
+static void orderMoves(const Board& board, std::vector<Move>& moves) {
+    std::vector<std::pair<int, Move>> keyed;
+    keyed.reserve(moves.size());
+    for (const auto& move : moves) {
+        int key = 0;
+        if (isCapture(board, move)) {
+            int see = staticExchange(board, move);
+            key = see >= 0 ? 1000000 + see : see;
+        }
+        keyed.emplace_back(key, move);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < moves.size(); ++i) moves[i] = keyed[i].second;
+}
+
+// Наибольшее расстояние от корня, до которого хранится главный вариант
+static const int MAX_PLY = MATE_SCORE - MATE_BOUND;
+
+// Память таблицы главных вариантов (MAX_PLY строк по MAX_PLY ходов, 320 КБ):
+// одна на поток и переиспользуется. Очищать не нужно — строка читается
+// только на pvLength своих ходов, а pvLength у каждого поиска свой.
+static Move* pvBuffer() {
+    static thread_local std::vector<Move> buffer(MAX_PLY * MAX_PLY);
+    return buffer.data();
+}
+
+// Состояние одного поиска: счётчик узлов и условия остановки
+struct SearchContext {
+    EvalBackend backend;
+    TranspositionTable* tt = nullptr;
+    uint64_t nodes = 0;
+    uint64_t nodeLimit = 0;
+    int64_t timeMs = 0;
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline = false;
+    bool pondering = false;
+    bool stopped = false;
+    bool deterministic = false; // poll() не вызывается
+    SearchControl* control = nullptr;
+    int maxDepth = 0;
+    int completedDepth = 0;
+    int rootDepth = 0; // глубина текущей итерации: предел для продлений
+
+    // Треугольная таблица главных вариантов: строка ply — вариант из узла
+    // на этом расстоянии от корня, собирается из строки ply + 1 при улучшении.
+    // Буфер потока: в одном потоке одновременно идёт только один поиск.
+    Move* pvTable = pvBuffer();
+    int pvLength[MAX_PLY] = {};
+    // Вариант прошлой итерации: пока поиск идёт по нему, его ход — первый
+    std::vector<Move> prevPv;
+    bool followPv = false;
+
+    // Хеши позиций текущего пути (индекс — ply) и партии до корня: повторения
+    uint64_t pathHashes[MAX_PLY] = {};
+    const std::vector<uint64_t>* gameHistory = nullptr;
+
+    void updatePv(int ply, const Move& move) {
+        Move* row = &pvTable[ply * MAX_PLY];
+        const Move* child = &pvTable[(ply + 1) * MAX_PLY];
+        row[0] = move;
+        std::copy(child, child + pvLength[ply + 1], row + 1);
+        pvLength[ply] = pvLength[ply + 1] + 1;
+    }
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            const Piece* piece = board.getPiece({row, col});
-            if (!piece) continue;
+    std::vector<Move> pv(int ply) const {
+        const Move* row = &pvTable[ply * MAX_PLY];
+        return std::vector<Move>(row, row + pvLength[ply]);
+    }
 
-            int value = getPieceValue(piece->type) + getPieceSquareBonus(piece, row, col);
+    bool shouldStop() {
+        if (stopped) return true;
+        if (nodeLimit && !pondering && nodes >= nodeLimit) stopped = true;
+        // Часы и флаги управления — раз в 1024 узла: вызов часов не бесплатен
+        if ((nodes & 1023) == 0 && !deterministic) poll();
+        return stopped;
+    }
 
-            if (piece->color == Color::White) {
-                score += value;
-            } else {
-                score -= value;
+    void poll() {
+        auto now = std::chrono::steady_clock::now();
+        if (control) {
+            if (control->stop.load(std::memory_order_relaxed)) {
+                stopped = true;
+                return;
+            }
+            if (pondering && !control->pondering.load(std::memory_order_relaxed)) {
+                pondering = false; // ponderhit: время на ход — с этого момента
+                // Нужная глубина уже просчитана за время соперника
+                if (completedDepth >= maxDepth) {
+                    stopped = true;
+                    return;
+                }
+                if (timeMs > 0) {
+                    deadline = now + std::chrono::milliseconds(timeMs);
+                    hasDeadline = true;
+                }
             }
         }
+        if (!pondering && hasDeadline && now >= deadline) stopped = true;
     }
+};
 
-    return score;
+// Поиск взятий в листьях: без него оценка обрывается посреди размена.
+// Стоящая сторона может остановиться (stand pat); под шахом смотрим все ответы.
+// Взятия с отрицательным SEE не рассматриваются.
+static int quiescence(Board& board, int ply, int alpha, int beta, bool maximizing, Color side,
+                      SearchContext& ctx) {
+    ctx.nodes++;
+    ctx.pvLength[ply] = 0;
+    if (ctx.shouldStop()) return 0;
+
+    bool inCheck = board.isInCheck(side);
+    int bestEval = maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    if (!inCheck || ply >= MAX_PLY - 1) {
+        int standPat = evaluateBoard(board, ctx.backend);
+        if (ply >= MAX_PLY - 1) return standPat;
+        bestEval = standPat;
+        if (maximizing) {
+            if (standPat >= beta) return standPat;
+            alpha = std::max(alpha, standPat);
+        } else {
+            if (standPat <= alpha) return standPat;
+            beta = std::min(beta, standPat);
+        }
+    }
+
+    std::vector<Move> moves = board.getLegalMoves(side);
+    if (moves.empty()) {
+        if (inCheck) return maximizing ? -(MATE_SCORE - ply) : MATE_SCORE - ply;
+        return 0; // Пат
+    }
+
+    if (!inCheck) {
+        moves.erase(std::remove_if(moves.begin(), moves.end(), [&board](const Move& move) {
+            return !isCapture(board, move) || staticExchange(board, move) < 0;
+        }), moves.end());
+    }
+    orderMoves(board, moves);
+
+    for (const auto& move : moves) {
+        Board copy = board.copyForTest();
+        copy.makeMove(move);
+        int eval = quiescence(copy, ply + 1, alpha, beta, !maximizing, oppositeColor(side), ctx);
+        if (maximizing ? eval > bestEval : eval < bestEval) {
+            bestEval = eval;
+            ctx.updatePv(ply, move);
+        }
+        if (maximizing) {
+            alpha = std::max(alpha, eval);
+        } else {
+            beta = std::min(beta, eval);
+        }
+        if (beta <= alpha) break;
+    }
+    return bestEval;
 }
 
-// --- Minimax с alpha-beta отсечением ---
+// Повторение позиции hash на расстоянии не дальше последнего необратимого хода.
+// Повтор на пути поиска хотя бы раз уже ничья: сторона, которой это выгодно,
+// может повторить снова. Позиция из партии до корня — ничья только при двух
+// совпадениях, как троекратное повторение в Board::evaluateGameState.
+static bool isRepetition(const SearchContext& ctx, int ply, uint64_t hash, int halfmoveClock) {
+    // На пути поиска та же сторона ходила через 2, 4, ... полухода
+    int limit = std::min(ply, halfmoveClock);
+    for (int back = 2; back <= limit; back += 2) {
+        if (ctx.pathHashes[ply - back] == hash) return true;
+    }
 
-static int minimax(Board& board, int depth, int alpha, int beta, bool maximizing, Color side) {
-    if (depth == 0) {
-        return evaluateBoard(board);
+    // История партии; корень в ней обычно последний и уже есть в пути
+    if (!ctx.gameHistory || halfmoveClock <= ply) return false;
+    const auto& history = *ctx.gameHistory;
+    size_t end = history.size();
+    if (end > 0 && history[end - 1] == ctx.pathHashes[0]) end--;
+    size_t window = std::min(end, static_cast<size_t>(halfmoveClock - ply));
+    int count = 0;
+    for (size_t i = end - window; i < end; ++i) {
+        if (history[i] == hash && ++count >= 2) return true;
     }
+    return false;
+}
+
+static int minimax(Board& board, int depth, int ply, int alpha, int beta, bool maximizing,
+                   Color side, SearchContext& ctx) {
+    ctx.nodes++;
+    ctx.pvLength[ply] = 0;
+    if (ctx.shouldStop()) return 0; // результат прерванной итерации отбрасывается
+
+    // Ничьи по правилам обрывают циклы и бесцельное маневрирование
+    uint64_t hash = board.getHash(side);
+    ctx.pathHashes[ply] = hash;
+    if (board.getHalfmoveClock() >= 100) {
+        // Мат последним ходом важнее правила 50 ходов
+        if (board.isInCheck(side) && !board.hasLegalMove(side)) {
+            return maximizing ? -(MATE_SCORE - ply) : MATE_SCORE - ply;
+        }
+        return 0;
+    }
+    if (isRepetition(ctx, ply, hash, board.getHalfmoveClock())) return 0;
+
+    if (auto tbScore = probeTablebaseInSearch(board, depth, side)) {
+        return *tbScore;
+    }
+
+    // Продление шахов: форсированные линии не обрываются на горизонте.
+    // Продления ограничены удвоенной глубиной итерации.
+    bool inCheck = board.isInCheck(side);
+    bool canExtend = ply < 2 * ctx.rootDepth;
+    if (inCheck && canExtend) depth++;
+
+    if (depth == 0 || ply >= MAX_PLY - 1) {
+        return quiescence(board, ply, alpha, beta, maximizing, side, ctx);
+    }
+
+    // Сужение окна по расстоянию до мата: быстрее уже найденного мата не будет
+    int matedNow = MATE_SCORE - ply;      // ходящей стороне мат в этой позиции
+    int mateNext = MATE_SCORE - ply - 1;  // ходящая сторона ставит мат следующим ходом
+    alpha = std::max(alpha, maximizing ? -matedNow : -mateNext);
+    beta = std::min(beta, maximizing ? mateNext : matedNow);
+    if (alpha >= beta) return alpha;
+
+    // Таблица транспозиций: отсечение по сохранённой оценке и ход для сортировки
+    std::optional<Move> ttMove;
+    std::optional<TTEntry> ttEntry;
+    if (ctx.tt) {
+        ttEntry = ctx.tt->probe(hash);
+        if (ttEntry) {
+            ttMove = ttEntry->move;
+            ttEntry->score = scoreFromTt(ttEntry->score, ply);
+            if (ttEntry->depth >= depth) {
+                int score = ttEntry->score;
+                if (ttEntry->bound == TTBound::Exact) return score;
+                if (ttEntry->bound == TTBound::Lower && score >= beta) return score;
+                if (ttEntry->bound == TTBound::Upper && score <= alpha) return score;
+            }
+        }
+    }
+    int alphaOrig = alpha;
+    int betaOrig = beta;
 
     std::vector<Move> moves = board.getLegalMoves(side);
 
     // Проверка на конец игры
     if (moves.empty()) {
-        if (board.isInCheck(side)) {
-            // Мат: чем быстрее, тем лучше (или хуже для проигравшего)
-            return maximizing ? (-100000 - depth) : (100000 + depth);
-        }
+        // Мат: чем быстрее, тем лучше (или хуже для проигравшего)
+        if (inCheck) return maximizing ? -matedNow : matedNow;
         return 0; // Пат
     }
 
-    // Сортировка: взятия первыми для лучшего alpha-beta отсечения
-    std::sort(moves.begin(), moves.end(), [&board](const Move& a, const Move& b) {
-        bool aCapture = board.getPiece(a.to) != nullptr;
-        bool bCapture = board.getPiece(b.to) != nullptr;
-        return aCapture > bCapture;
-    });
+    orderMoves(board, moves);
+    // Лучший ход из таблицы — первым, а на варианте прошлой итерации — его ход
+    if (ttMove) moveToFront(moves, *ttMove);
+    bool onPv = ctx.followPv && ply < static_cast<int>(ctx.prevPv.size());
+    if (onPv) moveToFront(moves, ctx.prevPv[ply]);
 
-    if (maximizing) {
-        int maxEval = std::numeric_limits<int>::min();
+    // Сингулярное продление: если ход из таблицы заметно лучше всех остальных
+    // (они не дотягивают до его оценки с запасом на уменьшенной глубине),
+    // линия держится на одном ходе — его смотрим на ход глубже
+    bool singular = false;
+    if (canExtend && !inCheck && depth >= SINGULAR_MIN_DEPTH && ttMove && moves.size() > 1 &&
+        ttEntry->depth >= depth - 3 && std::abs(ttEntry->score) < MATE_BOUND &&
+        ttEntry->bound != (maximizing ? TTBound::Upper : TTBound::Lower) &&
+        std::find(moves.begin(), moves.end(), *ttMove) != moves.end()) {
+        int margin = SINGULAR_MARGIN * depth;
+        int bound = maximizing ? ttEntry->score - margin : ttEntry->score + margin;
+        ctx.followPv = false;
+        singular = true;
         for (const auto& move : moves) {
+            if (move == *ttMove) continue;
             Board copy = board.copyForTest();
             copy.makeMove(move);
-            int eval = minimax(copy, depth - 1, alpha, beta, false, oppositeColor(side));
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) break;
+            // Нулевое окно вокруг bound: важно лишь, достаёт ли ход до него
+            int eval = maximizing
+                ? minimax(copy, (depth - 1) / 2, ply + 1, bound - 1, bound, false, oppositeColor(side), ctx)
+                : minimax(copy, (depth - 1) / 2, ply + 1, bound, bound + 1, true, oppositeColor(side), ctx);
+            if (maximizing ? eval >= bound : eval <= bound) {
+                singular = false;
+                break;
+            }
         }
-        return maxEval;
-    } else {
-        int minEval = std::numeric_limits<int>::max();
-        for (const auto& move : moves) {
-            Board copy = board.copyForTest();
-            copy.makeMove(move);
-            int eval = minimax(copy, depth - 1, alpha, beta, true, oppositeColor(side));
-            minEval = std::min(minEval, eval);
+        if (ctx.stopped) return 0;
+    }
+
+    int bestEval = maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    const Move* bestMove = nullptr;
+    for (const auto& move : moves) {
+        Board copy = board.copyForTest();
+        copy.makeMove(move);
+        if (ctx.tt) ctx.tt->prefetch(copy.getHash(oppositeColor(side)));
+        ctx.followPv = onPv && move == ctx.prevPv[ply];
+        int childDepth = depth - 1 + (singular && move == *ttMove ? 1 : 0);
+        int eval = minimax(copy, childDepth, ply + 1, alpha, beta, !maximizing,
+                           oppositeColor(side), ctx);
+        if (maximizing ? eval > bestEval : eval < bestEval) {
+            bestEval = eval;
+            bestMove = &move;
+            ctx.updatePv(ply, move);
+        }
+        if (maximizing) {
+            alpha = std::max(alpha, eval);
+        } else {
             beta = std::min(beta, eval);
-            if (beta <= alpha) break;
         }
-        return minEval;
+        if (beta <= alpha) break;
+    }
+
+    if (ctx.tt && !ctx.stopped) {
+        TTBound bound = bestEval <= alphaOrig ? TTBound::Upper
+                      : bestEval >= betaOrig ? TTBound::Lower
+                      : TTBound::Exact;
+        ctx.tt->store(hash, depth, scoreToTt(bestEval, ply), bound, *bestMove);
     }
+    return bestEval;
 }
 
-Move findBestMove(Board& board, Color side) {
-    std::vector<Move> moves = board.getLegalMoves(side);
+// Выбор хода в корне по DTZ. Выигрыш — кратчайший путь к обнуляющему ходу,
+// проигрыш — длиннейший. При ничьей moves сужается до ничейных ходов,
+// а выбор между ними остаётся поиску.
+static std::optional<RootTablebaseMove> probeTablebaseRoot(Board& board, Color side, std::vector<Move>& moves) {
+    if (!canProbeTablebases(board)) return std::nullopt;
+
+    std::vector<RootTablebaseMove> ranked = probeRootDtz(board, side);
+    if (ranked.empty()) return std::nullopt;
 
-    // Сортировка: взятия первыми
-    std::sort(moves.begin(), moves.end(), [&board](const Move& a, const Move& b) {
-        bool aCapture = board.getPiece(a.to) != nullptr;
-        bool bCapture = board.getPiece(b.to) != nullptr;
-        return aCapture > bCapture;
-    });
+    int bestRank = std::max_element(ranked.begin(), ranked.end(),
+        [](const RootTablebaseMove& a, const RootTablebaseMove& b) { return a.rank < b.rank; })->rank;
+
+    if (bestRank == 0) {
+        moves.clear();
+        for (const auto& rm : ranked) {
+            if (rm.rank == 0) moves.push_back(rm.move);
+        }
+        return std::nullopt;
+    }
 
+    const RootTablebaseMove* best = nullptr;
+    for (const auto& rm : ranked) {
+        if (rm.rank != bestRank) continue;
+        // Для выигрыша меньший dtz — быстрее, для проигрыша — дольше
+        if (!best || rm.dtz < best->dtz) best = &rm;
+    }
+    return *best;
+}
+
+// Один проход корня на заданную глубину; false — поиск прерван
+static bool searchRoot(Board& board, Color side, int depth, std::vector<Move>& moves,
+                       SearchContext& ctx, RootLine& line) {
     bool maximizing = (side == Color::White);
-    int bestScore = maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
-    Move bestMove = moves[0];
+    line.score = maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    line.move = moves[0];
+    line.pv = {line.move};
 
     int alpha = std::numeric_limits<int>::min();
     int beta = std::numeric_limits<int>::max();
@@ -164,22 +466,228 @@ Move findBestMove(Board& board, Color side) {
     for (const auto& move : moves) {
         Board copy = board.copyForTest();
         copy.makeMove(move);
-        int score = minimax(copy, 3, alpha, beta, !maximizing, oppositeColor(side));
+        ctx.followPv = !ctx.prevPv.empty() && move == ctx.prevPv[0];
+        int score = minimax(copy, depth - 1, 1, alpha, beta, !maximizing, oppositeColor(side), ctx);
+        if (ctx.stopped) return false;
 
+        if (maximizing ? score > line.score : score < line.score) {
+            line.score = score;
+            line.move = move;
+            ctx.updatePv(0, move);
+            line.pv = ctx.pv(0);
+        }
         if (maximizing) {
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove = move;
-            }
             alpha = std::max(alpha, score);
         } else {
-            if (score < bestScore) {
-                bestScore = score;
-                bestMove = move;
-            }
             beta = std::min(beta, score);
         }
     }
+    return true;
+}
+
+// Вариант, оборванный отсечением по таблице, достраиваем её лучшими ходами.
+// Повтор позиции обрывает достройку, чтобы не зациклиться.
+static void extendPvFromTt(const Board& board, Color side, std::vector<Move>& pv, size_t maxLength,
+                           const TranspositionTable& tt) {
+    Board pos = board.copyForTest();
+    std::vector<uint64_t> seen = {pos.getHash(side)};
+    for (const auto& move : pv) {
+        pos.makeMove(move);
+        side = oppositeColor(side);
+        seen.push_back(pos.getHash(side));
+    }
+    while (pv.size() < maxLength) {
+        auto entry = tt.probe(pos.getHash(side));
+        if (!entry || !entry->move || !pos.isMoveLegal(*entry->move, side)) break;
+        pos.makeMove(*entry->move);
+        side = oppositeColor(side);
+        uint64_t hash = pos.getHash(side);
+        if (std::find(seen.begin(), seen.end(), hash) != seen.end()) break;
+        seen.push_back(hash);
+        pv.push_back(*entry->move);
+    }
+}
+
+// Время и счётчики выделений памяти за поиск
+static void finishResult(SearchResult& result, std::chrono::steady_clock::time_point start,
+                         const PieceAllocStats& allocStart, uint64_t heapStart) {
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    PieceAllocStats allocEnd = pieceAllocStats();
+    result.pieceAllocations = allocEnd.allocations - allocStart.allocations;
+    result.poolRefills = allocEnd.poolRefills - allocStart.poolRefills;
+    result.heapAllocations = heapAllocations() - heapStart;
+}
 
-    return bestMove;
+SearchResult search(Board& board, Color side, const SearchLimits& limits,
+                    const SearchOptions& options, SearchControl* control,
+                    const SearchInfoCallback& onInfo) {
+    auto start = std::chrono::steady_clock::now();
+    PieceAllocStats allocStart = pieceAllocStats();
+    uint64_t heapStart = heapAllocations();
+    SearchResult result;
+
+    std::vector<Move> moves = board.getLegalMoves(side);
+    if (moves.empty()) return result;
+    result.bestMove = moves[0];
+
+    // Ход из таблиц — законченный ответ: одна линия глубины 1 с оценкой WDL
+    if (auto tbMove = probeTablebaseRoot(board, side, moves)) {
+        result.bestMove = tbMove->move;
+        result.score = tablebaseScore(tbMove->wdl, 0, side);
+        result.depth = 1;
+        result.lines = {RootLine{tbMove->move, result.score, {tbMove->move}}};
+        finishResult(result, start, allocStart, heapStart);
+        if (onInfo) {
+            SearchInfo info;
+            info.depth = result.depth;
+            info.score = result.score;
+            info.pv = result.lines[0].pv;
+            info.seconds = result.seconds;
+            onInfo(info);
+        }
+        return result;
+    }
+
+    orderMoves(board, moves);
+
+    SearchContext ctx;
+    ctx.backend = options.backend;
+    ctx.tt = options.tt;
+    if (ctx.tt) ctx.tt->newSearch();
+    ctx.pathHashes[0] = board.getHash(side);
+    ctx.gameHistory = &board.getPositionHistory();
+    ctx.nodeLimit = limits.nodes;
+    ctx.deterministic = limits.deterministic;
+    ctx.timeMs = limits.deterministic ? 0 : limits.timeMs;
+    ctx.control = limits.deterministic ? nullptr : control;
+    ctx.pondering = !limits.deterministic && limits.ponder && control && control->pondering.load();
+    if (ctx.timeMs > 0 && !ctx.pondering) {
+        ctx.deadline = start + std::chrono::milliseconds(limits.timeMs);
+        ctx.hasDeadline = true;
+    }
+
+    // MultiPV: k-я линия — лучший ход корня среди ещё не найденных на этой
+    // итерации. Следующие проходы идут по уже заполненной таблице транспозиций.
+    size_t lineCount = std::min(moves.size(), static_cast<size_t>(std::max(1, options.multiPv)));
+
+    const int MAX_DEPTH = 64;
+    ctx.maxDepth = limits.depth > 0 ? limits.depth : MAX_DEPTH;
+    for (int depth = 1; depth <= (ctx.pondering ? MAX_DEPTH : ctx.maxDepth); ++depth) {
+        std::vector<RootLine> lines;
+        std::vector<Move> remaining = moves;
+        while (lines.size() < lineCount) {
+            // k-я линия начинается с варианта k-й линии прошлой итерации
+            size_t k = lines.size();
+            ctx.prevPv = k < result.lines.size() ? result.lines[k].pv : std::vector<Move>{};
+            ctx.rootDepth = depth;
+            RootLine line;
+            if (!searchRoot(board, side, depth, remaining, ctx, line)) break;
+            if (ctx.tt) extendPvFromTt(board, side, line.pv, depth, *ctx.tt);
+            remaining.erase(std::find(remaining.begin(), remaining.end(), line.move));
+            lines.push_back(std::move(line));
+        }
+        if (ctx.stopped) break; // незавершённая итерация не используется
+
+        result.bestMove = lines[0].move;
+        result.score = lines[0].score;
+        result.depth = depth;
+        result.lines = lines;
+        ctx.completedDepth = depth;
+        if (ctx.tt) ctx.tt->store(board.getHash(side), depth, lines[0].score, TTBound::Exact, lines[0].move);
+
+        if (onInfo) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            for (size_t k = 0; k < lines.size(); ++k) {
+                SearchInfo info;
+                info.depth = depth;
+                info.multiPv = static_cast<int>(k) + 1;
+                info.score = lines[k].score;
+                info.pv = lines[k].pv;
+                info.nodes = ctx.nodes;
+                info.seconds = seconds;
+                onInfo(info);
+            }
+        }
+
+        // Найденные линии следующей итерации смотрим первыми, в том же порядке
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) moveToFront(moves, it->move);
+    }
+
+    // Во время обдумывания ход не отдаём до ponderhit или stop
+    while (ctx.pondering && !ctx.stopped) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ctx.poll();
+    }
+
+    result.nodes = ctx.nodes;
+    finishResult(result, start, allocStart, heapStart);
+    return result;
+}
+
+// --- Асинхронный поиск ---
+
+SearchHandle& SearchHandle::operator=(SearchHandle&& other) {
+    if (this != &other) {
+        stop();
+        if (result_.valid()) result_.wait();
+        control_ = std::move(other.control_);
+        result_ = std::move(other.result_);
+    }
+    return *this;
+}
+
+SearchHandle::~SearchHandle() {
+    stop();
+    if (result_.valid()) result_.wait();
+}
+
+bool SearchHandle::ready() const {
+    return result_.valid() &&
+           result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void SearchHandle::stop() {
+    if (control_) control_->stop.store(true, std::memory_order_relaxed);
+}
+
+void SearchHandle::ponderhit() {
+    if (control_) control_->pondering.store(false, std::memory_order_relaxed);
+}
+
+SearchResult SearchHandle::get() {
+    return result_.get();
+}
+
+SearchHandle startSearch(const Board& board, Color side, const SearchLimits& limits,
+                         const SearchOptions& options, SearchInfoCallback onInfo, ThreadPool* pool) {
+    SearchHandle handle;
+    handle.control_ = std::make_shared<SearchControl>();
+    handle.control_->pondering.store(limits.ponder);
+
+    // Задача владеет копией доски и состоянием управления —
+    // ручку можно разрушить раньше, чем поиск заметит stop
+    auto position = std::make_shared<Board>(board.copyWithHistory());
+    auto task = [position, side, limits, options, control = handle.control_,
+                 onInfo = std::move(onInfo)]() {
+        return search(*position, side, limits, options, control.get(), onInfo);
+    };
+
+    handle.result_ = pool ? pool->async(std::move(task))
+                          : std::async(std::launch::async, std::move(task));
+    return handle;
+}
+
+int quiescenceEval(Board& board, Color side, EvalBackend backend) {
+    SearchContext ctx;
+    ctx.backend = backend;
+    return quiescence(board, 0, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+                      side == Color::White, side, ctx);
+}
+
+Move findBestMove(Board& board, Color side) {
+    SearchOptions options;
+    options.backend = getEvalBackend();
+    SearchLimits limits;
+    limits.deterministic = true;
+    return search(board, side, limits, options).bestMove;
 }
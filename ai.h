@@ -4,11 +4,127 @@
 #include "board.h"
 #include "move.h"
 #include "pieces.h"
+#include "threadpool.h"
+#include "tt.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Источник статической оценки: piece-square таблицы или NNUE
+enum class EvalBackend { Pst, Nnue };
+
+// Переключение оценки во время работы (для A/B-сравнения).
+// NNUE используется, только если сеть загружена (loadNnue).
+void setEvalBackend(EvalBackend backend);
+EvalBackend getEvalBackend();
 
 // Оценка позиции с точки зрения белых
 int evaluateBoard(const Board& board);
+int evaluateBoard(const Board& board, EvalBackend backend);
+
+// Настройки движка для поиска
+struct SearchOptions {
+    EvalBackend backend = EvalBackend::Pst;
+    TranspositionTable* tt = nullptr; // nullptr — без таблицы транспозиций
+    int multiPv = 1;                  // сколько лучших корневых ходов искать
+};
+
+// Ограничения поиска; 0 — без ограничения
+struct SearchLimits {
+    int depth = 4;        // максимальная глубина итеративного углубления
+    int64_t timeMs = 0;   // время на ход
+    uint64_t nodes = 0;   // число узлов
+    bool ponder = false;  // начать в режиме обдумывания на времени соперника
+    // Воспроизводимый поиск: только глубина и узлы, без часов и флагов управления.
+    // Одна и та же позиция с той же (пустой) таблицей даёт те же ходы и узлы.
+    bool deterministic = false;
+};
+
+// Одна из лучших линий корня (MultiPV)
+struct RootLine {
+    Move move{};
+    int score = 0;          // с точки зрения белых
+    std::vector<Move> pv;   // главный вариант, начиная с move
+};
+
+struct SearchResult {
+    Move bestMove{};
+    int score = 0;        // с точки зрения белых
+    int depth = 0;        // последняя полностью просчитанная глубина
+    uint64_t nodes = 0;
+    double seconds = 0;
+    uint64_t pieceAllocations = 0;   // фигур выделено из пула за поиск (копии досок)
+    uint64_t poolRefills = 0;        // пополнений пула фигур у системы
+    uint64_t heapAllocations = 0;    // вызовы operator new в потоке поиска (только make PROFILE=1)
+    std::vector<RootLine> lines; // лучшие ходы от лучшего к худшему, не больше multiPv
+};
+
+// Промежуточный результат после каждой завершённой итерации
+struct SearchInfo {
+    int depth = 0;
+    int multiPv = 1;        // номер линии (1 — лучшая)
+    int score = 0;          // с точки зрения белых
+    std::vector<Move> pv;   // главный вариант
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+using SearchInfoCallback = std::function<void(const SearchInfo&)>;
+
+// Управление поиском из другого потока. Флаги проверяются раз в 1024 узла.
+// Пока pondering == true, лимиты времени и глубины не действуют;
+// после снятия флага (ponderhit) время на ход отсчитывается заново.
+struct SearchControl {
+    std::atomic<bool> stop{false};
+    std::atomic<bool> pondering{false};
+};
+
+// Итеративное углубление minimax + alpha-beta. Если время или узлы
+// закончились посреди итерации, берётся ход предыдущей полной итерации.
+// onInfo вызывается в потоке поиска.
+SearchResult search(Board& board, Color side, const SearchLimits& limits,
+                    const SearchOptions& options, SearchControl* control = nullptr,
+                    const SearchInfoCallback& onInfo = {});
+
+// Поиск, идущий в фоне. Разрушение ручки останавливает поиск и ждёт его завершения.
+class SearchHandle {
+public:
+    SearchHandle() = default;
+    SearchHandle(SearchHandle&&) = default;
+    SearchHandle& operator=(SearchHandle&& other);
+    ~SearchHandle();
+
+    bool valid() const { return result_.valid(); }
+    // Завершён ли поиск (get() не заблокирует)
+    bool ready() const;
+    // Остановить досрочно: результат — последняя завершённая итерация
+    void stop();
+    // Соперник сделал ожидаемый ход — обдумывание становится обычным поиском
+    void ponderhit();
+    // Дождаться результата (один раз)
+    SearchResult get();
+
+private:
+    friend SearchHandle startSearch(const Board&, Color, const SearchLimits&, const SearchOptions&,
+                                    SearchInfoCallback, ThreadPool*);
+    std::shared_ptr<SearchControl> control_;
+    std::future<SearchResult> result_;
+};
+
+// Запуск поиска на копии позиции. С pool — задача пула, иначе отдельный поток.
+// Таблица транспозиций из options должна жить до завершения поиска.
+SearchHandle startSearch(const Board& board, Color side, const SearchLimits& limits,
+                         const SearchOptions& options, SearchInfoCallback onInfo = {},
+                         ThreadPool* pool = nullptr);
+
+// Оценка позиции поиском взятий (с точки зрения белых): статическая оценка,
+// уточнённая до конца разменов
+int quiescenceEval(Board& board, Color side, EvalBackend backend);
 
-// Поиск лучшего хода для заданной стороны (minimax + alpha-beta, глубина 4)
+// Поиск лучшего хода для заданной стороны (глубина 4, текущая оценка)
 Move findBestMove(Board& board, Color side);
 
 #endif
@@ -0,0 +1,38 @@
+#include "allocstats.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef CHESS_PROFILE
+// Счётчик без конструктора: доступен и до инициализации статических объектов
+static thread_local uint64_t heapCount = 0;
+
+uint64_t heapAllocations() {
+    return heapCount;
+}
+
+void* operator new(std::size_t size) {
+    ++heapCount;
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* ptr = std::malloc(size)) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#else
+
+uint64_t heapAllocations() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <cstdint>
+
+// Число вызовов глобального operator new в текущем потоке с его начала.
+// operator new заменяется в allocstats.cpp только в сборке make PROFILE=1
+// (CHESS_PROFILE), в обычной сборке всегда 0. Считаются и new[], и контейнеры
+// STL; формы с выравниванием больше стандартного (alignas(32) и т. п.) — нет.
+uint64_t heapAllocations();
+
+#endif
@@ -0,0 +1,55 @@
+#include "bench.h"
+#include "tt.h"
+#include <memory>
+
+// Дебют, миттельшпиль с тактикой, эндшпили; первые три — позиции perft
+static const std::vector<std::string> BENCH_FENS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+    "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8",
+    "r2q1rk1/ppp2ppp/2np1n2/2b1p1B1/2B1P1b1/2NP1N2/PPP2PPP/R2Q1RK1 w - - 6 8",
+    "2rq1rk1/pb1nbppp/1p2pn2/2ppN3/3P1B2/2PBP3/PP1N1PPP/R2QK2R w KQ - 2 11",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/8/2p5/8/B2K4/8 w - - 0 1",
+    "8/5k2/8/3PK3/8/8/8/8 w - - 0 1",
+    "4k3/8/8/8/8/8/8/4K2R w K - 0 1",
+};
+
+const std::vector<std::string>& benchPositions() {
+    return BENCH_FENS;
+}
+
+bool runBench(int depth, size_t hashMb, EvalBackend backend, BenchResult& result, std::string& error,
+              const std::function<void(const BenchPosition&)>& onPosition) {
+    result = BenchResult{};
+    for (const auto& fen : BENCH_FENS) {
+        Board board;
+        Color side;
+        if (!board.loadFen(fen, side, error)) return false;
+
+        // Своя пустая таблица на позицию: результат не зависит от порядка позиций
+        std::unique_ptr<TranspositionTable> tt;
+        if (hashMb > 0) tt = std::make_unique<TranspositionTable>(hashMb);
+        SearchOptions options;
+        options.backend = backend;
+        options.tt = tt.get();
+        SearchLimits limits;
+        limits.depth = depth;
+        limits.deterministic = true;
+
+        SearchResult found = search(board, side, limits, options);
+        BenchPosition position;
+        position.fen = fen;
+        position.bestMove = found.bestMove;
+        position.nodes = found.nodes;
+        position.seconds = found.seconds;
+        result.nodes += position.nodes;
+        result.seconds += position.seconds;
+        result.positions.push_back(position);
+        if (onPosition) onPosition(position);
+    }
+    return true;
+}
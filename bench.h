@@ -0,0 +1,35 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "ai.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Эталонный набор позиций для проверки производительности. Поиск в нём
+// воспроизводимый (SearchLimits::deterministic), поэтому сумма узлов зависит
+// только от кода поиска и оценки: её изменение — изменение поведения,
+// изменение скорости при той же сумме — чистая оптимизация.
+
+const std::vector<std::string>& benchPositions();
+
+struct BenchPosition {
+    std::string fen;
+    Move bestMove{};
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+struct BenchResult {
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<BenchPosition> positions;
+};
+
+// Поиск каждой позиции набора на глубину depth с новой таблицей hashMb МБ
+// (0 — без таблицы). onPosition вызывается после каждой позиции.
+bool runBench(int depth, size_t hashMb, EvalBackend backend, BenchResult& result, std::string& error,
+              const std::function<void(const BenchPosition&)>& onPosition = {});
+
+#endif
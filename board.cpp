@@ -1,7 +1,11 @@
 #include "board.h"
+#include "profile.h"
+#include "psqt.h"
+#include "zobrist.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 
 Board::Board() {
     for (int r = 0; r < 8; ++r)
@@ -10,9 +14,92 @@ Board::Board() {
 }
 
 void Board::placePiece(int row, int col, std::unique_ptr<Piece> piece) {
+    removePiece(row, col);
+    if (piece) {
+        invalidateAttacks();
+        uint64_t key = zobristPieceKey(piece->color, piece->type, row, col);
+        hash_ ^= key;
+        if (piece->type == PieceType::Pawn) pawnHash_ ^= key;
+        psqt_ += psqtValue(piece->color, piece->type, row, col);
+        phase_ += phaseValue(piece->type);
+        pieceCount_++;
+        if (piece->type == PieceType::King) kingSq_[static_cast<int>(piece->color)] = row * 8 + col;
+        if (isNnueLoaded()) updateNnue(*piece, row * 8 + col, true);
+    }
     grid_[row][col] = std::move(piece);
 }
 
+std::unique_ptr<Piece> Board::removePiece(int row, int col) {
+    auto piece = std::move(grid_[row][col]);
+    if (piece) {
+        invalidateAttacks();
+        uint64_t key = zobristPieceKey(piece->color, piece->type, row, col);
+        hash_ ^= key;
+        if (piece->type == PieceType::Pawn) pawnHash_ ^= key;
+        psqt_ -= psqtValue(piece->color, piece->type, row, col);
+        phase_ -= phaseValue(piece->type);
+        pieceCount_--;
+        if (piece->type == PieceType::King) kingSq_[static_cast<int>(piece->color)] = -1;
+        if (isNnueLoaded()) updateNnue(*piece, row * 8 + col, false);
+    }
+    return piece;
+}
+
+void Board::refreshEval() {
+    psqt_ = 0;
+    phase_ = 0;
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            const Piece* piece = grid_[r][c].get();
+            if (!piece) continue;
+            psqt_ += psqtValue(piece->color, piece->type, r, c);
+            phase_ += phaseValue(piece->type);
+        }
+    }
+}
+
+void Board::invalidateAttacks() {
+    attackedValid_[0] = attackedValid_[1] = false;
+    pinnedValid_[0] = pinnedValid_[1] = false;
+}
+
+void Board::updateNnue(const Piece& piece, int sq, bool add) {
+    // Ход короля меняет все признаки его перспективы — проще пересчитать её позже
+    if (piece.type == PieceType::King) {
+        nnue_.valid[static_cast<int>(piece.color)] = false;
+        return;
+    }
+    for (int p = 0; p < 2; ++p) {
+        if (!nnue_.valid[p]) continue;
+        int feature = nnueFeatureIndex(static_cast<Color>(p), kingSq_[p], piece.color, piece.type, sq);
+        if (add) {
+            nnueAddFeature(nnue_.values[p], feature);
+        } else {
+            nnueSubFeature(nnue_.values[p], feature);
+        }
+    }
+}
+
+const NnueAccumulator& Board::getNnueAccumulator() const {
+    for (int p = 0; p < 2; ++p) {
+        if (nnue_.valid[p]) continue;
+        nnueResetPerspective(nnue_.values[p]);
+        if (kingSq_[p] >= 0) {
+            for (int r = 0; r < 8; ++r) {
+                for (int c = 0; c < 8; ++c) {
+                    const auto* piece = grid_[r][c].get();
+                    if (!piece || piece->type == PieceType::King) continue;
+                    nnueAddFeature(nnue_.values[p],
+                                   nnueFeatureIndex(static_cast<Color>(p), kingSq_[p],
+                                                    piece->color, piece->type, r * 8 + c));
+                }
+            }
+        }
+        nnue_.valid[p] = true;
+    }
+    return nnue_;
+}
+
 void Board::setupInitialPosition() {
     // Белые фигуры (ряд 0 = rank 1)
     placePiece(0, 0, std::make_unique<Rook>(Color::White));
@@ -47,6 +134,175 @@ void Board::setupInitialPosition() {
     positionHistory_.clear();
 }
 
+bool Board::loadFen(const std::string& fen, Color& sideToMove, std::string& error) {
+    std::istringstream iss(fen);
+    std::string placement, side, castling = "-", enPassant = "-";
+    int halfmove = 0;
+    iss >> placement >> side;
+    if (placement.empty() || (side != "w" && side != "b")) {
+        error = "неверный FEN: " + fen;
+        return false;
+    }
+    iss >> castling >> enPassant >> halfmove;
+
+    BoardSetup setup;
+
+    // Расстановка: горизонтали с 8-й по 1-ю, внутри — с вертикали a
+    int row = 7, col = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (col != 8 || row == 0) {
+                error = "неверная расстановка в FEN: " + placement;
+                return false;
+            }
+            row--;
+            col = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            col += ch - '0';
+        } else {
+            Color color = std::isupper(static_cast<unsigned char>(ch)) ? Color::White : Color::Black;
+            int type = -1;
+            switch (std::tolower(static_cast<unsigned char>(ch))) {
+                case 'p': type = static_cast<int>(PieceType::Pawn); break;
+                case 'n': type = static_cast<int>(PieceType::Knight); break;
+                case 'b': type = static_cast<int>(PieceType::Bishop); break;
+                case 'r': type = static_cast<int>(PieceType::Rook); break;
+                case 'q': type = static_cast<int>(PieceType::Queen); break;
+                case 'k': type = static_cast<int>(PieceType::King); break;
+            }
+            if (type < 0 || col > 7) {
+                error = "неверная расстановка в FEN: " + placement;
+                return false;
+            }
+            setup.squares[row * 8 + col++] = static_cast<int8_t>(static_cast<int>(color) * 6 + type);
+        }
+        if (col > 8) {
+            error = "неверная расстановка в FEN: " + placement;
+            return false;
+        }
+    }
+    if (row != 0 || col != 8) {
+        error = "неверная расстановка в FEN: " + placement;
+        return false;
+    }
+
+    for (char ch : castling) {
+        switch (ch) {
+            case 'K': setup.castling[0] = true; break;
+            case 'Q': setup.castling[1] = true; break;
+            case 'k': setup.castling[2] = true; break;
+            case 'q': setup.castling[3] = true; break;
+        }
+    }
+
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' ||
+            (enPassant[1] != '3' && enPassant[1] != '6')) {
+            error = "неверное поле en passant в FEN: " + enPassant;
+            return false;
+        }
+        setup.enPassant = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+    }
+
+    setup.halfmoveClock = halfmove;
+    setup.sideToMove = (side == "w") ? Color::White : Color::Black;
+    if (!this->setup(setup, error)) {
+        error = "неверная расстановка в FEN: " + placement;
+        return false;
+    }
+    sideToMove = setup.sideToMove;
+    return true;
+}
+
+bool Board::setup(const BoardSetup& setup, std::string& error) {
+    // Проверка до изменений: неверная позиция не портит текущую
+    int kings[2] = {0, 0};
+    for (int sq = 0; sq < 64; ++sq) {
+        int code = setup.squares[sq];
+        if (code < -1 || code >= 12) {
+            error = "неверный код фигуры";
+            return false;
+        }
+        if (code >= 0 && static_cast<PieceType>(code % 6) == PieceType::King) kings[code / 6]++;
+    }
+    if (kings[0] != 1 || kings[1] != 1) {
+        error = "в позиции должно быть по одному королю";
+        return false;
+    }
+    if (setup.enPassant < -1 || setup.enPassant >= 64 || setup.halfmoveClock < 0) {
+        error = "неверные en passant или счётчик полуходов";
+        return false;
+    }
+
+    for (int r = 0; r < 8; ++r)
+        for (int c = 0; c < 8; ++c)
+            removePiece(r, c);
+    positionHistory_.clear();
+
+    for (int sq = 0; sq < 64; ++sq) {
+        int code = setup.squares[sq];
+        if (code < 0) continue;
+        Color color = static_cast<Color>(code / 6);
+        std::unique_ptr<Piece> piece;
+        switch (static_cast<PieceType>(code % 6)) {
+            case PieceType::Pawn:   piece = std::make_unique<Pawn>(color); break;
+            case PieceType::Knight: piece = std::make_unique<Knight>(color); break;
+            case PieceType::Bishop: piece = std::make_unique<Bishop>(color); break;
+            case PieceType::Rook:   piece = std::make_unique<Rook>(color); break;
+            case PieceType::Queen:  piece = std::make_unique<Queen>(color); break;
+            case PieceType::King:   piece = std::make_unique<King>(color); break;
+        }
+        // Рокировку разрешают только права позиции — остальные фигуры считаем сходившими
+        piece->moved_ = true;
+        placePiece(sq / 8, sq % 8, std::move(piece));
+    }
+
+    // Права рокировки: король и ладья должны стоять на исходных полях
+    auto allowCastle = [this](int row, int rookCol) {
+        Piece* king = grid_[row][4].get();
+        Piece* rook = grid_[row][rookCol].get();
+        Color color = (row == 0) ? Color::White : Color::Black;
+        if (!king || king->type != PieceType::King || king->color != color) return false;
+        if (!rook || rook->type != PieceType::Rook || rook->color != color) return false;
+        king->moved_ = false;
+        rook->moved_ = false;
+        return true;
+    };
+    whiteKingsideCastle_ = setup.castling[0] && allowCastle(0, 7);
+    whiteQueensideCastle_ = setup.castling[1] && allowCastle(0, 0);
+    blackKingsideCastle_ = setup.castling[2] && allowCastle(7, 7);
+    blackQueensideCastle_ = setup.castling[3] && allowCastle(7, 0);
+
+    if (setup.enPassant >= 0) {
+        enPassantTarget_ = Square{setup.enPassant / 8, setup.enPassant % 8};
+    } else {
+        enPassantTarget_ = std::nullopt;
+    }
+    halfmoveClock_ = setup.halfmoveClock;
+    return true;
+}
+
+BoardSetup Board::toSetup(Color sideToMove) const {
+    BoardSetup setup;
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            const Piece* p = grid_[r][c].get();
+            if (p) {
+                setup.squares[r * 8 + c] =
+                    static_cast<int8_t>(static_cast<int>(p->color) * 6 + static_cast<int>(p->type));
+            }
+        }
+    }
+    setup.castling[0] = whiteKingsideCastle_;
+    setup.castling[1] = whiteQueensideCastle_;
+    setup.castling[2] = blackKingsideCastle_;
+    setup.castling[3] = blackQueensideCastle_;
+    if (enPassantTarget_) setup.enPassant = enPassantTarget_->row * 8 + enPassantTarget_->col;
+    setup.halfmoveClock = halfmoveClock_;
+    setup.sideToMove = sideToMove;
+    return setup;
+}
+
 void Board::display(bool flipped) const {
     std::cout << "\n";
     if (!flipped) {
@@ -94,6 +350,15 @@ bool Board::canCastleQueenside(Color c) const {
 // Проверка, атакована ли клетка фигурами данного цвета
 // Проверяем от целевой клетки наружу — эффективнее полной генерации ходов
 bool Board::isSquareAttackedBy(const Square& sq, Color byColor) const {
+    PROFILE_SCOPE(IsSquareAttackedBy);
+    if (attackedValid_[static_cast<int>(byColor)]) {
+        return attacked_[static_cast<int>(byColor)] & (1ULL << (sq.row * 8 + sq.col));
+    }
+    return scanAttack(sq, byColor);
+}
+
+// Одиночный запрос без карты: лучи от поля до первой фигуры
+bool Board::scanAttack(const Square& sq, Color byColor) const {
     // Проверка атаки пешкой
     int pawnDir = (byColor == Color::White) ? -1 : 1; // откуда атакует пешка
     for (int dc : {-1, 1}) {
@@ -171,25 +436,183 @@ bool Board::isSquareAttackedBy(const Square& sq, Color byColor) const {
     return false;
 }
 
-bool Board::isInCheck(Color side) const {
-    Square king = findKing(side);
-    return isSquareAttackedBy(king, oppositeColor(side));
+uint64_t Board::attackedSquares(Color by) const {
+    int c = static_cast<int>(by);
+    if (attackedValid_[c]) return attacked_[c];
+
+    static const std::pair<int,int> knightOffsets[] = {
+        {2,1},{2,-1},{-2,1},{-2,-1},{1,2},{1,-2},{-1,2},{-1,-2}
+    };
+    static const std::pair<int,int> dirs[] = {
+        {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}
+    };
+
+    uint64_t attacked = 0;
+    auto add = [&attacked](int row, int col) {
+        if (row >= 0 && row < 8 && col >= 0 && col < 8) attacked |= 1ULL << (row * 8 + col);
+    };
+    for (int r = 0; r < 8; ++r) {
+        for (int col = 0; col < 8; ++col) {
+            const auto* p = grid_[r][col].get();
+            if (!p || p->color != by) continue;
+            switch (p->type) {
+                case PieceType::Pawn: {
+                    int dir = (by == Color::White) ? 1 : -1;
+                    add(r + dir, col - 1);
+                    add(r + dir, col + 1);
+                    break;
+                }
+                case PieceType::Knight:
+                    for (auto [dr, dc] : knightOffsets) add(r + dr, col + dc);
+                    break;
+                case PieceType::King:
+                    for (auto [dr, dc] : dirs) add(r + dr, col + dc);
+                    break;
+                default: {
+                    // Ладья — первые 4 направления, слон — последние 4, ферзь — все
+                    int first = p->type == PieceType::Bishop ? 4 : 0;
+                    int last = p->type == PieceType::Rook ? 4 : 8;
+                    for (int d = first; d < last; ++d) {
+                        auto [dr, dc] = dirs[d];
+                        for (int i = 1; i < 8; ++i) {
+                            int tr = r + dr * i, tc = col + dc * i;
+                            if (tr < 0 || tr >= 8 || tc < 0 || tc >= 8) break;
+                            add(tr, tc);
+                            if (grid_[tr][tc]) break;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    attacked_[c] = attacked;
+    attackedValid_[c] = true;
+    return attacked;
 }
 
-Square Board::findKing(Color side) const {
+uint64_t Board::pinnedPieces(Color side) const {
+    int c = static_cast<int>(side);
+    if (pinnedValid_[c]) return pinned_[c];
+
+    uint64_t pinned = 0;
+    int king = kingSq_[c];
+    if (king >= 0) {
+        static const std::pair<int,int> dirs[] = {
+            {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}
+        };
+        for (int d = 0; d < 8; ++d) {
+            auto [dr, dc] = dirs[d];
+            PieceType slider = d < 4 ? PieceType::Rook : PieceType::Bishop;
+            int candidate = -1; // первая своя фигура на луче
+            for (int i = 1; i < 8; ++i) {
+                int r = king / 8 + dr * i, col = king % 8 + dc * i;
+                if (r < 0 || r >= 8 || col < 0 || col >= 8) break;
+                const auto* p = grid_[r][col].get();
+                if (!p) continue;
+                if (p->color == side) {
+                    if (candidate >= 0) break; // две свои фигуры — связки нет
+                    candidate = r * 8 + col;
+                    continue;
+                }
+                if (candidate >= 0 && (p->type == slider || p->type == PieceType::Queen)) {
+                    pinned |= 1ULL << candidate;
+                }
+                break;
+            }
+        }
+    }
+
+    pinned_[c] = pinned;
+    pinnedValid_[c] = true;
+    return pinned;
+}
+
+uint64_t Board::occupancy() const {
+    uint64_t occupied = 0;
     for (int r = 0; r < 8; ++r) {
         for (int c = 0; c < 8; ++c) {
-            const auto* p = grid_[r][c].get();
-            if (p && p->type == PieceType::King && p->color == side) {
-                return {r, c};
+            if (grid_[r][c]) occupied |= 1ULL << (r * 8 + c);
+        }
+    }
+    return occupied;
+}
+
+uint64_t Board::attackersTo(const Square& sq, uint64_t occupied) const {
+    uint64_t attackers = 0;
+    // Фигура на поле s, если оно входит в occupied
+    auto pieceAt = [&](const Square& s) -> const Piece* {
+        if (!(occupied & (1ULL << (s.row * 8 + s.col)))) return nullptr;
+        return getPiece(s);
+    };
+    auto add = [&](const Square& s) { attackers |= 1ULL << (s.row * 8 + s.col); };
+
+    // Пешки: белая бьёт с ряда ниже, чёрная — с ряда выше
+    for (Color color : {Color::White, Color::Black}) {
+        int pawnDir = (color == Color::White) ? -1 : 1;
+        for (int dc : {-1, 1}) {
+            Square s{sq.row + pawnDir, sq.col + dc};
+            if (!s.isValid()) continue;
+            const auto* p = pieceAt(s);
+            if (p && p->color == color && p->type == PieceType::Pawn) add(s);
+        }
+    }
+
+    static const std::pair<int,int> knightOffsets[] = {
+        {2,1},{2,-1},{-2,1},{-2,-1},{1,2},{1,-2},{-1,2},{-1,-2}
+    };
+    for (auto [dr, dc] : knightOffsets) {
+        Square s{sq.row + dr, sq.col + dc};
+        if (!s.isValid()) continue;
+        const auto* p = pieceAt(s);
+        if (p && p->type == PieceType::Knight) add(s);
+    }
+
+    for (int dr = -1; dr <= 1; ++dr) {
+        for (int dc = -1; dc <= 1; ++dc) {
+            if (dr == 0 && dc == 0) continue;
+            Square s{sq.row + dr, sq.col + dc};
+            if (!s.isValid()) continue;
+            const auto* p = pieceAt(s);
+            if (p && p->type == PieceType::King) add(s);
+        }
+    }
+
+    // Скользящие: первая фигура из occupied на луче
+    static const std::pair<int,int> dirs[] = {
+        {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}
+    };
+    for (int d = 0; d < 8; ++d) {
+        auto [dr, dc] = dirs[d];
+        PieceType slider = d < 4 ? PieceType::Rook : PieceType::Bishop;
+        for (int i = 1; i < 8; ++i) {
+            Square s{sq.row + dr * i, sq.col + dc * i};
+            if (!s.isValid()) break;
+            const auto* p = pieceAt(s);
+            if (p) {
+                if (p->type == slider || p->type == PieceType::Queen) add(s);
+                break;
             }
         }
     }
-    // Не должно произойти в корректной игре
-    return {-1, -1};
+    return attackers;
+}
+
+bool Board::isInCheck(Color side) const {
+    Square king = findKing(side);
+    return isSquareAttackedBy(king, oppositeColor(side));
+}
+
+Square Board::findKing(Color side) const {
+    int sq = kingSq_[static_cast<int>(side)];
+    // sq < 0 не должно произойти в корректной игре
+    if (sq < 0) return {-1, -1};
+    return {sq / 8, sq % 8};
 }
 
 Board Board::copyForTest() const {
+    PROFILE_SCOPE(CopyForTest);
     Board copy;
     for (int r = 0; r < 8; ++r) {
         for (int c = 0; c < 8; ++c) {
@@ -204,11 +627,32 @@ Board Board::copyForTest() const {
     copy.blackQueensideCastle_ = blackQueensideCastle_;
     copy.enPassantTarget_ = enPassantTarget_;
     copy.halfmoveClock_ = halfmoveClock_;
+    copy.hash_ = hash_;
+    copy.pawnHash_ = pawnHash_;
+    copy.psqt_ = psqt_;
+    copy.phase_ = phase_;
+    copy.pieceCount_ = pieceCount_;
+    copy.kingSq_[0] = kingSq_[0];
+    copy.kingSq_[1] = kingSq_[1];
+    for (int c = 0; c < 2; ++c) {
+        copy.attacked_[c] = attacked_[c];
+        copy.attackedValid_[c] = attackedValid_[c];
+        copy.pinned_[c] = pinned_[c];
+        copy.pinnedValid_[c] = pinnedValid_[c];
+    }
+    if (isNnueLoaded()) copy.nnue_ = nnue_;
     // positionHistory_ не копируем — не нужна для проверки легальности
     return copy;
 }
 
+Board Board::copyWithHistory() const {
+    Board copy = copyForTest();
+    copy.positionHistory_ = positionHistory_;
+    return copy;
+}
+
 bool Board::isMoveLegal(const Move& move, Color side) const {
+    PROFILE_SCOPE(IsMoveLegal);
     // Проверяем, что на клетке "от" стоит фигура нужного цвета
     const auto* piece = getPiece(move.from);
     if (!piece || piece->color != side) return false;
@@ -226,26 +670,32 @@ bool Board::isMoveLegal(const Move& move, Color side) const {
     }
     if (!found) return false;
 
-    // Рокировка — дополнительная проверка: король не под шахом, промежуточные поля не атакованы
-    if (piece->type == PieceType::King) {
-        int colDiff = move.to.col - move.from.col;
-        if (std::abs(colDiff) == 2) {
-            // Рокировка
-            if (isInCheck(side)) return false; // нельзя рокировать под шахом
-
-            // Проверяем промежуточное поле
-            int step = (colDiff > 0) ? 1 : -1;
-            Square intermediate{move.from.row, move.from.col + step};
-            if (isSquareAttackedBy(intermediate, oppositeColor(side))) {
-                return false;
-            }
+    return isPseudoMoveLegal(move, side, *piece);
+}
 
-            // Проверяем целевое поле
-            if (isSquareAttackedBy(move.to, oppositeColor(side))) {
-                return false;
+bool Board::isPseudoMoveLegal(const Move& move, Color side, const Piece& piece) const {
+    int king = kingSq_[static_cast<int>(side)];
+    if (king >= 0) {
+        uint64_t enemy = attackedSquares(oppositeColor(side));
+        bool inCheck = enemy & (1ULL << king);
+        auto attacked = [enemy](const Square& sq) { return (enemy >> (sq.row * 8 + sq.col)) & 1; };
+
+        if (piece.type == PieceType::King) {
+            int colDiff = move.to.col - move.from.col;
+            if (std::abs(colDiff) == 2) {
+                // Рокировка: король не под шахом, промежуточное и целевое поля не атакованы
+                Square intermediate{move.from.row, move.from.col + (colDiff > 0 ? 1 : -1)};
+                return !inCheck && !attacked(intermediate) && !attacked(move.to);
             }
-
-            return true; // рокировка не может оставить короля под шахом
+            // Без шаха ни одна дальнобойная фигура не смотрит на короля,
+            // поэтому уход короля не открывает новых атак
+            if (!inCheck) return !attacked(move.to);
+        } else if (!inCheck && !(pinnedPieces(side) & (1ULL << (move.from.row * 8 + move.from.col)))) {
+            // Несвязанная фигура без шаха ходит свободно; взятие на проходе
+            // снимает две пешки с горизонтали — его проверяем полностью
+            bool enPassant = piece.type == PieceType::Pawn && move.from.col != move.to.col &&
+                             !getPiece(move.to);
+            if (!enPassant) return true;
         }
     }
 
@@ -258,6 +708,7 @@ bool Board::isMoveLegal(const Move& move, Color side) const {
 }
 
 std::vector<Move> Board::getLegalMoves(Color side) const {
+    PROFILE_SCOPE(GetLegalMoves);
     std::vector<Move> legalMoves;
     for (int r = 0; r < 8; ++r) {
         for (int c = 0; c < 8; ++c) {
@@ -267,7 +718,7 @@ std::vector<Move> Board::getLegalMoves(Color side) const {
             Square pos{r, c};
             auto pseudoMoves = piece->generatePseudoLegalMoves(pos, *this);
             for (const auto& move : pseudoMoves) {
-                if (isMoveLegal(move, side)) {
+                if (isPseudoMoveLegal(move, side, *piece)) {
                     legalMoves.push_back(move);
                 }
             }
@@ -276,7 +727,44 @@ std::vector<Move> Board::getLegalMoves(Color side) const {
     return legalMoves;
 }
 
+bool Board::hasLegalMove(Color side) const {
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            const auto* piece = grid_[r][c].get();
+            if (!piece || piece->color != side) continue;
+
+            Square pos{r, c};
+            for (const auto& move : piece->generatePseudoLegalMoves(pos, *this)) {
+                if (isPseudoMoveLegal(move, side, *piece)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Board::isInsufficientMaterial() const {
+    // Пешка, ладья или ферзь — материала достаточно, дальше не смотрим
+    int knights = 0;
+    int bishopColors[2] = {0, 0};
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            const auto* piece = grid_[r][c].get();
+            if (!piece) continue;
+            switch (piece->type) {
+                case PieceType::King:   break;
+                case PieceType::Knight: knights++; break;
+                case PieceType::Bishop: bishopColors[(r + c) % 2]++; break;
+                default:                return false;
+            }
+        }
+    }
+    bool bishopsOneColor = bishopColors[0] == 0 || bishopColors[1] == 0;
+    if (knights == 0) return bishopsOneColor;
+    return knights == 1 && bishopColors[0] + bishopColors[1] == 0;
+}
+
 void Board::makeMove(const Move& move) {
+    PROFILE_SCOPE(MakeMove);
     auto& fromCell = grid_[move.from.row][move.from.col];
     auto& toCell = grid_[move.to.row][move.to.col];
 
@@ -287,7 +775,7 @@ void Board::makeMove(const Move& move) {
     if (isPawn && enPassantTarget_.has_value() && move.to == enPassantTarget_.value()) {
         // Удаляем захваченную пешку
         int capturedRow = move.from.row; // пешка стоит на том же ряду, что и наша
-        grid_[capturedRow][move.to.col] = nullptr;
+        removePiece(capturedRow, move.to.col);
         isCapture = true;
     }
 
@@ -298,11 +786,11 @@ void Board::makeMove(const Move& move) {
             // Перемещаем ладью
             if (colDiff > 0) {
                 // Короткая рокировка
-                grid_[move.from.row][5] = std::move(grid_[move.from.row][7]);
+                placePiece(move.from.row, 5, removePiece(move.from.row, 7));
                 grid_[move.from.row][5]->moved_ = true;
             } else {
                 // Длинная рокировка
-                grid_[move.from.row][3] = std::move(grid_[move.from.row][0]);
+                placePiece(move.from.row, 3, removePiece(move.from.row, 0));
                 grid_[move.from.row][3]->moved_ = true;
             }
         }
@@ -351,23 +839,36 @@ void Board::makeMove(const Move& move) {
 
     // Перемещение фигуры
     fromCell->moved_ = true;
-    toCell = std::move(fromCell);
+    placePiece(move.to.row, move.to.col, removePiece(move.from.row, move.from.col));
 
     // Превращение пешки
     if (toCell->type == PieceType::Pawn && move.promotion != '\0') {
         Color col = toCell->color;
+        std::unique_ptr<Piece> promoted;
         switch (move.promotion) {
-            case 'q': toCell = std::make_unique<Queen>(col); break;
-            case 'r': toCell = std::make_unique<Rook>(col); break;
-            case 'b': toCell = std::make_unique<Bishop>(col); break;
-            case 'n': toCell = std::make_unique<Knight>(col); break;
-            default: toCell = std::make_unique<Queen>(col); break;
+            case 'q': promoted = std::make_unique<Queen>(col); break;
+            case 'r': promoted = std::make_unique<Rook>(col); break;
+            case 'b': promoted = std::make_unique<Bishop>(col); break;
+            case 'n': promoted = std::make_unique<Knight>(col); break;
+            default: promoted = std::make_unique<Queen>(col); break;
         }
-        toCell->moved_ = true;
+        promoted->moved_ = true;
+        placePiece(move.to.row, move.to.col, std::move(promoted));
     }
 }
 
-// FEN-подобная строка позиции для определения троекратного повторения
+uint64_t Board::getHash(Color sideToMove) const {
+    uint64_t h = hash_;
+    if (whiteKingsideCastle_) h ^= ZOBRIST.castling[0];
+    if (whiteQueensideCastle_) h ^= ZOBRIST.castling[1];
+    if (blackKingsideCastle_) h ^= ZOBRIST.castling[2];
+    if (blackQueensideCastle_) h ^= ZOBRIST.castling[3];
+    if (enPassantTarget_.has_value()) h ^= ZOBRIST.enPassant[enPassantTarget_->col];
+    if (sideToMove == Color::Black) h ^= ZOBRIST.side;
+    return h;
+}
+
+// FEN-подобная строка позиции
 std::string Board::getPositionKey(Color sideToMove) const {
     std::ostringstream oss;
 
@@ -414,14 +915,14 @@ std::string Board::getPositionKey(Color sideToMove) const {
 }
 
 GameState Board::evaluateGameState(Color sideToMove) {
-    auto legalMoves = getLegalMoves(sideToMove);
+    bool inCheck;
+    return evaluateGameState(sideToMove, inCheck);
+}
 
-    if (legalMoves.empty()) {
-        if (isInCheck(sideToMove)) {
-            return GameState::Checkmate;
-        } else {
-            return GameState::Stalemate;
-        }
+GameState Board::evaluateGameState(Color sideToMove, bool& inCheck) {
+    inCheck = isInCheck(sideToMove);
+    if (!hasLegalMove(sideToMove)) {
+        return inCheck ? GameState::Checkmate : GameState::Stalemate;
     }
 
     // Правило 50 ходов
@@ -429,18 +930,28 @@ GameState Board::evaluateGameState(Color sideToMove) {
         return GameState::DrawBy50Moves;
     }
 
-    // Троекратное повторение
-    std::string currentKey = getPositionKey(sideToMove);
+    // Троекратное повторение. Повториться могут только позиции после последнего
+    // необратимого хода (взятие, ход пешки) — их не больше halfmoveClock_.
+    uint64_t key = getHash(sideToMove);
+    size_t size = positionHistory_.size();
+    // Та же позиция ещё раз (повторная проверка без хода) — не новое повторение
+    if (size > 0 && positionHistory_[size - 1] == key) size--;
+    size_t window = std::min(size, static_cast<size_t>(halfmoveClock_));
     int count = 0;
-    for (const auto& key : positionHistory_) {
-        if (key == currentKey) count++;
+    for (size_t i = size - window; i < size; ++i) {
+        if (positionHistory_[i] == key) count++;
     }
     if (count >= 2) { // текущая + 2 предыдущих = 3
         return GameState::DrawByRepetition;
     }
 
+    if (isInsufficientMaterial()) {
+        return GameState::DrawByInsufficientMaterial;
+    }
+
     // Сохраняем текущую позицию в историю
-    positionHistory_.push_back(currentKey);
+    positionHistory_.resize(size);
+    positionHistory_.push_back(key);
 
     return GameState::InProgress;
 }
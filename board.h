@@ -1,7 +1,10 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "nnue.h"
 #include "pieces.h"
+#include "score.h"
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -12,7 +15,21 @@ enum class GameState {
     Checkmate,
     Stalemate,
     DrawBy50Moves,
-    DrawByRepetition
+    DrawByRepetition,
+    DrawByInsufficientMaterial
+};
+
+// Позиция в виде данных: общий путь загрузки для FEN и бинарных записей
+struct BoardSetup {
+    int8_t squares[64];        // поле row * 8 + col: -1 — пусто, иначе цвет * 6 + тип фигуры
+    bool castling[4] = {};     // K, Q, k, q
+    int enPassant = -1;        // поле row * 8 + col для взятия на проходе, -1 — нет
+    int halfmoveClock = 0;
+    Color sideToMove = Color::White;
+
+    BoardSetup() {
+        for (auto& sq : squares) sq = -1;
+    }
 };
 
 class Board {
@@ -20,6 +37,17 @@ public:
     Board();
 
     void setupInitialPosition();
+
+    // Загрузка позиции из FEN (номер хода игнорируется).
+    // При ошибке возвращает false и описание в error; позиция на доске не меняется.
+    bool loadFen(const std::string& fen, Color& sideToMove, std::string& error);
+
+    // Расстановка из данных. Права рокировки без короля и ладьи на исходных
+    // полях отбрасываются. false и error (доска не меняется), если у стороны
+    // не ровно один король или данные вне диапазона.
+    bool setup(const BoardSetup& setup, std::string& error);
+    BoardSetup toSetup(Color sideToMove) const;
+
     void display(bool flipped = false) const;
 
     // Доступ к фигурам
@@ -32,26 +60,68 @@ public:
     // En passant
     std::optional<Square> getEnPassantTarget() const { return enPassantTarget_; }
 
-    // Проверка атаки
+    // Счётчик полуходов для правила 50 ходов
+    int getHalfmoveClock() const { return halfmoveClock_; }
+    // Число фигур на доске, включая королей и пешки
+    int getPieceCount() const { return pieceCount_; }
+
+    // Проверка атаки: по карте атак, если она уже посчитана, иначе обходом лучей
     bool isSquareAttackedBy(const Square& sq, Color byColor) const;
+    // Карта полей, атакованных цветом by (бит row * 8 + col). Считается лениво
+    // один раз на позицию и сбрасывается при любом изменении доски.
+    uint64_t attackedSquares(Color by) const;
+    // Фигуры цвета side, связанные с собственным королём
+    uint64_t pinnedPieces(Color side) const;
     bool isInCheck(Color side) const;
+    // Занятые поля: бит row * 8 + col
+    uint64_t occupancy() const;
+    // Все фигуры обоих цветов, бьющие поле sq, при занятости occupied.
+    // Фигуры вне occupied не бьют и не закрывают линии — так открываются
+    // рентгеновские атаки из-за снятых фигур.
+    uint64_t attackersTo(const Square& sq, uint64_t occupied) const;
     Square findKing(Color side) const;
 
     // Глубокая копия для проверки легальности
     Board copyForTest() const;
+    // То же вместе с историей партии — для поиска, который видит повторения
+    Board copyWithHistory() const;
+    // Хеши позиций партии, запомненных evaluateGameState, от первой к текущей
+    const std::vector<uint64_t>& getPositionHistory() const { return positionHistory_; }
 
     // Легальность хода
     bool isMoveLegal(const Move& move, Color side) const;
     std::vector<Move> getLegalMoves(Color side) const;
+    // Есть ли хоть один легальный ход: останавливается на первом найденном
+    bool hasLegalMove(Color side) const;
+    // Ни одна сторона не может поставить мат: K против K, K + лёгкая фигура,
+    // только слоны одного цвета полей
+    bool isInsufficientMaterial() const;
 
     // Выполнение хода (без проверки легальности — должна быть выполнена заранее)
     void makeMove(const Move& move);
 
-    // FEN-подобный ключ позиции для троекратного повторения
+    // FEN-подобный ключ позиции (без счётчиков ходов)
     std::string getPositionKey(Color sideToMove) const;
 
-    // Оценка состояния игры
+    // Zobrist-хеш позиции (фигуры, рокировки, en passant, сторона хода)
+    uint64_t getHash(Color sideToMove) const;
+    // Хеш только пешек обоих цветов — ключ для пешечной хеш-таблицы
+    uint64_t getPawnHash() const { return pawnHash_; }
+
+    // Материал + piece-square (mg/eg, с точки зрения белых) и фаза игры,
+    // поддерживаются инкрементально
+    Score getPsqtScore() const { return psqt_; }
+    int getPhase() const { return phase_; }
+    // Пересчитать их заново (после setEvalParams)
+    void refreshEval();
+
+    // Аккумулятор NNUE; невалидные перспективы пересчитываются при обращении
+    const NnueAccumulator& getNnueAccumulator() const;
+
+    // Оценка состояния игры; вызывается раз на позицию партии и запоминает её
+    // для повторений. inCheck — стоит ли sideToMove под шахом.
     GameState evaluateGameState(Color sideToMove);
+    GameState evaluateGameState(Color sideToMove, bool& inCheck);
 
 private:
     std::unique_ptr<Piece> grid_[8][8];
@@ -64,9 +134,32 @@ private:
 
     std::optional<Square> enPassantTarget_;
     int halfmoveClock_ = 0;
-    std::vector<std::string> positionHistory_;
+    std::vector<uint64_t> positionHistory_; // хеши позиций партии (getHash)
+
+    // Инкрементальные хеши и оценка, обновляются в placePiece/removePiece
+    uint64_t hash_ = 0;
+    uint64_t pawnHash_ = 0;
+    Score psqt_ = 0;
+    int phase_ = 0;
+    int pieceCount_ = 0;
+
+    // Поля королей (row * 8 + col), -1 — короля нет
+    int kingSq_[2] = {-1, -1};
+    mutable NnueAccumulator nnue_;
+
+    // Лениво посчитанные карты атак и связок по цветам
+    mutable uint64_t attacked_[2] = {0, 0};
+    mutable uint64_t pinned_[2] = {0, 0};
+    mutable bool attackedValid_[2] = {false, false};
+    mutable bool pinnedValid_[2] = {false, false};
 
     void placePiece(int row, int col, std::unique_ptr<Piece> piece);
+    std::unique_ptr<Piece> removePiece(int row, int col);
+    void updateNnue(const Piece& piece, int sq, bool add);
+    void invalidateAttacks();
+    bool scanAttack(const Square& sq, Color byColor) const;
+    // Легальность псевдолегального хода piece (фигуры на move.from)
+    bool isPseudoMoveLegal(const Move& move, Color side, const Piece& piece) const;
 };
 
 #endif
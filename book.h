@@ -0,0 +1,45 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "board.h"
+#include "move.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Выбор хода из книги
+enum class BookSelection {
+    Best,           // ход с наибольшим весом
+    WeightedRandom  // случайный ход пропорционально весам
+};
+
+// Ключ позиции в формате Polyglot (собственные случайные числа стандарта,
+// не совпадает с Board::getHash)
+uint64_t polyglotHash(const Board& board, Color sideToMove);
+
+// Дебютная книга Polyglot (.bin): файл отображается в память,
+// записи ищутся двоичным поиском по ключу
+class OpeningBook {
+public:
+    OpeningBook() = default;
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool isOpen() const { return data_ != nullptr; }
+    size_t size() const { return count_; }
+
+    // Легальный ход из книги для позиции или nullopt, если позиции в книге нет
+    std::optional<Move> probe(const Board& board, Color sideToMove,
+                              BookSelection selection = BookSelection::WeightedRandom) const;
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t mappedSize_ = 0;
+    size_t count_ = 0;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "datagen.h"
+#include "record.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+
+// Примеров в буфере потока перед сбросом в файл
+static const size_t FLUSH_SAMPLES = 4096;
+// Оценки выше — мат или таблицы окончаний: оценку по ним не обучить
+static const int MAX_SAMPLE_SCORE = 10000;
+
+// Общий файл результата; потоки пишут в него только целыми буферами
+struct DatagenOutput {
+    RecordWriter writer;
+    std::mutex mutex;
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> games{0};
+    bool failed = false;
+};
+
+static bool isCaptureOrPromotion(const Board& board, const Move& move) {
+    if (move.promotion != '\0' || board.getPiece(move.to)) return true;
+    const Piece* piece = board.getPiece(move.from);
+    return piece && piece->type == PieceType::Pawn && move.from.col != move.to.col;
+}
+
+// Спокойная позиция: нет шаха, лучший ход тихий и поиск взятий не меняет
+// статическую оценку — оценка позиции не зависит от незавершённого размена
+static bool isQuietSample(Board& board, Color side, const SearchResult& sr, EvalBackend backend) {
+    if (std::abs(sr.score) >= MAX_SAMPLE_SCORE) return false;
+    if (board.isInCheck(side) || isCaptureOrPromotion(board, sr.bestMove)) return false;
+    return quiescenceEval(board, side, backend) == evaluateBoard(board, backend);
+}
+
+static void flushSamples(const DatagenConfig& config, DatagenOutput& out,
+                         std::vector<TrainingSample>& buffer) {
+    std::lock_guard<std::mutex> lock(out.mutex);
+    uint64_t written = out.written.load();
+    size_t count = static_cast<size_t>(std::min<uint64_t>(buffer.size(), config.positions - written));
+    if (!out.failed && count > 0) {
+        if (out.writer.appendRecords(buffer.data(), count)) {
+            out.written = written + count;
+            std::cout << "Позиций: " << out.written << "/" << config.positions
+                      << ", партий: " << out.games << std::endl;
+        } else {
+            out.failed = true;
+        }
+    }
+    buffer.clear();
+}
+
+static void playGames(const DatagenConfig& config, unsigned worker, DatagenOutput& out) {
+    std::mt19937_64 rng(config.seed * 0x9E3779B97F4A7C15ULL + worker);
+    TranspositionTable tt(config.hashMb);
+
+    SearchOptions options;
+    options.backend = config.backend;
+    options.tt = &tt;
+    SearchLimits limits;
+    limits.depth = 0; // ограничение — только узлы
+    limits.nodes = config.nodes;
+
+    std::vector<TrainingSample> buffer;
+    std::vector<TrainingSample> gameSamples;
+    buffer.reserve(FLUSH_SAMPLES + 512);
+
+    while (out.written.load() < config.positions) {
+        Board board;
+        board.setupInitialPosition();
+        Color side = Color::White;
+        tt.clear();
+
+        // Случайное начало: без него партии с одинаковыми настройками совпадают
+        bool finished = false;
+        for (int i = 0; i < config.randomPlies && !finished; ++i) {
+            std::vector<Move> moves = board.getLegalMoves(side);
+            if (moves.empty()) {
+                finished = true;
+                break;
+            }
+            board.makeMove(moves[rng() % moves.size()]);
+            side = oppositeColor(side);
+        }
+        if (finished) continue;
+
+        gameSamples.clear();
+        int result = 0;
+        for (int ply = 0;; ++ply) {
+            GameState state = board.evaluateGameState(side);
+            if (state == GameState::Checkmate) {
+                result = side == Color::White ? -1 : 1;
+                break;
+            }
+            if (state != GameState::InProgress || ply >= config.maxPlies) break;
+
+            SearchResult sr = search(board, side, limits, options);
+            if (isQuietSample(board, side, sr, config.backend)) {
+                TrainingSample sample{};
+                packPosition(board, side, sample.position);
+                sample.score = static_cast<int16_t>(sr.score);
+                gameSamples.push_back(sample);
+            }
+            board.makeMove(sr.bestMove);
+            side = oppositeColor(side);
+        }
+
+        // Итог известен только в конце партии
+        for (auto& sample : gameSamples) sample.result = static_cast<int8_t>(result);
+        buffer.insert(buffer.end(), gameSamples.begin(), gameSamples.end());
+        out.games++;
+        if (buffer.size() >= FLUSH_SAMPLES) flushSamples(config, out, buffer);
+        if (out.failed) return;
+    }
+    flushSamples(config, out, buffer);
+}
+
+bool generateTrainingData(const DatagenConfig& config, ThreadPool& pool, DatagenStats& stats,
+                          std::string& error) {
+    DatagenOutput out;
+    if (!out.writer.open(config.outputPath, RecordKind::Samples, sizeof(TrainingSample), error)) {
+        return false;
+    }
+
+    for (unsigned worker = 0; worker < pool.size(); ++worker) {
+        pool.submit([&config, &out, worker]() { playGames(config, worker, out); });
+    }
+    pool.waitIdle();
+
+    stats.games = out.games;
+    stats.positions = out.written;
+    if (!out.writer.close(error)) return false;
+    if (out.failed) {
+        error = "ошибка записи в " + config.outputPath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include "ai.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <string>
+
+// Генерация обучающих данных партиями движка с самим собой.
+// Пишутся спокойные позиции с оценкой поиска и итогом партии (record.h, TrainingSample).
+
+struct DatagenConfig {
+    uint64_t positions = 100000; // сколько примеров записать
+    uint64_t nodes = 5000;       // узлов поиска на ход
+    int randomPlies = 8;         // случайные ходы в начале партии для разнообразия
+    int maxPlies = 400;          // дольше — ничья по присуждению
+    size_t hashMb = 2;           // таблица транспозиций каждого потока
+    uint64_t seed = 1;
+    EvalBackend backend = EvalBackend::Pst;
+    std::string outputPath;
+};
+
+struct DatagenStats {
+    uint64_t games = 0;
+    uint64_t positions = 0;
+};
+
+// Партии играются на всех потоках пула; у каждого потока свой буфер примеров,
+// в файл он сбрасывается блоком. Возвращает false и error при ошибке записи.
+bool generateTrainingData(const DatagenConfig& config, ThreadPool& pool, DatagenStats& stats,
+                          std::string& error);
+
+#endif
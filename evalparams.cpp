@@ -0,0 +1,72 @@
+#include "evalparams.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+
+static const char* PIECE_NAMES[6] = {"pawn", "rook", "knight", "bishop", "queen", "king"};
+
+std::string evalWeightName(int index) {
+    if (index < 6) return std::string("material.") + PIECE_NAMES[index];
+    index -= 6;
+    if (index < 6 * 64) {
+        int sq = index % 64;
+        std::string square = {static_cast<char>('a' + sq % 8), static_cast<char>('1' + sq / 8)};
+        return std::string("psqt.") + PIECE_NAMES[index / 64] + "." + square;
+    }
+    index -= 6 * 64;
+    if (index == 0) return "doubled_pawn";
+    if (index == 1) return "isolated_pawn";
+    index -= 2;
+    return "passed_pawn." + std::to_string(index + 1);
+}
+
+bool saveEvalParams(const EvalParams& params, const std::string& path, std::string& error) {
+    std::ofstream out(path);
+    if (!out) {
+        error = "не удалось создать " + path;
+        return false;
+    }
+    out << "# Параметры оценки: <имя> <миттельшпиль> <эндшпиль>\n";
+    const EvalWeight* weights = params.begin();
+    for (int i = 0; i < EvalParams::COUNT; ++i) {
+        out << evalWeightName(i) << " " << weights[i].mg << " " << weights[i].eg << "\n";
+    }
+    if (!out) {
+        error = "ошибка записи в " + path;
+        return false;
+    }
+    return true;
+}
+
+bool loadEvalParams(const std::string& path, EvalParams& params, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    std::map<std::string, int> indices;
+    for (int i = 0; i < EvalParams::COUNT; ++i) indices[evalWeightName(i)] = i;
+
+    // Ошибка в любой строке — параметры не меняются
+    EvalParams loaded = params;
+    EvalWeight* weights = loaded.begin();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        std::string name;
+        if (!(iss >> name) || name[0] == '#') continue;
+
+        auto it = indices.find(name);
+        EvalWeight w;
+        if (it == indices.end() || !(iss >> w.mg >> w.eg)) {
+            error = path + ":" + std::to_string(lineNumber) + ": неверная строка: " + line;
+            return false;
+        }
+        weights[it->second] = w;
+    }
+    params = loaded;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef EVALPARAMS_H
+#define EVALPARAMS_H
+
+#include <cstdint>
+#include <string>
+
+// Параметр оценки: пара (миттельшпиль, эндшпиль)
+struct EvalWeight {
+    int mg;
+    int eg;
+};
+
+// Все настраиваемые параметры PST-оценки, с точки зрения белых.
+// Структура состоит только из EvalWeight подряд, поэтому параметры
+// можно обходить как массив из COUNT элементов (настройка, файлы).
+struct EvalParams {
+    EvalWeight material[6];     // по PieceType; король — 0
+    EvalWeight psqt[6][64];     // бонус поля row * 8 + col для белых, без материала
+    EvalWeight doubledPawn;     // штраф за каждую лишнюю пешку на вертикали
+    EvalWeight isolatedPawn;    // штраф за изолированную пешку
+    EvalWeight passedPawn[8];   // бонус проходной по горизонтали от своего края
+
+    static constexpr int COUNT = 6 + 6 * 64 + 1 + 1 + 8;
+
+    EvalWeight* begin() { return &material[0]; }
+    const EvalWeight* begin() const { return &material[0]; }
+};
+static_assert(sizeof(EvalParams) == EvalParams::COUNT * sizeof(EvalWeight),
+              "EvalParams должна состоять из EvalWeight без промежутков");
+
+// Встроенные значения
+const EvalParams& defaultEvalParams();
+
+// Параметры, которыми сейчас оценивает движок (изначально встроенные).
+// setEvalParams пересчитывает таблицы PSQT и меняет поколение параметров;
+// вызывать только когда никто не ищет. Уже созданные доски нужно обновить
+// через Board::refreshEval, пешечные таблицы сбрасываются сами.
+const EvalParams& currentEvalParams();
+void setEvalParams(const EvalParams& params);
+uint32_t evalParamsGeneration();
+
+// Имя параметра в файле: "material.knight", "psqt.pawn.e4", "passed_pawn.6", ...
+std::string evalWeightName(int index);
+
+// Текстовый файл параметров: строка "<имя> <mg> <eg>", '#' — комментарий.
+// При загрузке незаданные параметры остаются как в params.
+bool saveEvalParams(const EvalParams& params, const std::string& path, std::string& error);
+bool loadEvalParams(const std::string& path, EvalParams& params, std::string& error);
+
+#endif
@@ -1,9 +1,13 @@
 #include "game.h"
 #include "ai.h"
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <algorithm>
 
+static const size_t DEFAULT_HASH_MB = 16;
+
 Game::Game()
     : whitePlayer_("Белые", Color::White)
     , blackPlayer_("Чёрные", Color::Black)
@@ -13,6 +17,7 @@ Game::Game()
     , flipped_(false)
 {
     board_.setupInitialPosition();
+    tt_ = std::make_unique<TranspositionTable>(DEFAULT_HASH_MB);
 }
 
 Game::Game(bool aiEnabled, Color aiColor)
@@ -24,6 +29,40 @@ Game::Game(bool aiEnabled, Color aiColor)
     , flipped_(aiColor == Color::White)
 {
     board_.setupInitialPosition();
+    tt_ = std::make_unique<TranspositionTable>(DEFAULT_HASH_MB);
+}
+
+void Game::setOpeningBook(const OpeningBook* book, BookSelection selection) {
+    book_ = book;
+    bookSelection_ = selection;
+}
+
+void Game::setHashSize(size_t sizeMb) {
+    tt_ = std::make_unique<TranspositionTable>(sizeMb);
+}
+
+SearchOptions Game::searchOptions() const {
+    SearchOptions options;
+    options.backend = getEvalBackend();
+    options.tt = tt_.get();
+    return options;
+}
+
+// Компьютер только что сходил: ожидаемый ответ игрока — лучший ход из таблицы
+// транспозиций, и пока игрок думает, ищем ответ на него
+void Game::startPondering() {
+    ponderMove_.reset();
+    if (!ponderEnabled_) return;
+
+    auto entry = tt_->probe(board_.getHash(currentTurn_));
+    if (!entry || !entry->move || !board_.isMoveLegal(*entry->move, currentTurn_)) return;
+
+    Board predicted = board_.copyWithHistory();
+    predicted.makeMove(*entry->move);
+    SearchLimits limits = limits_;
+    limits.ponder = true;
+    ponderMove_ = entry->move;
+    ponder_ = startSearch(predicted, aiColor_, limits, searchOptions());
 }
 
 Player& Game::getCurrentPlayer() {
@@ -38,6 +77,16 @@ bool Game::isAiTurn() const {
     return aiEnabled_ && currentTurn_ == aiColor_;
 }
 
+// Ход размышлений компьютера: глубина, оценка в пешках, узлы, главный вариант
+static void printSearchInfo(const SearchInfo& info) {
+    std::ostringstream line;
+    line << "  глубина " << info.depth << ", оценка " << std::showpos << std::fixed
+         << std::setprecision(2) << info.score / 100.0 << std::noshowpos
+         << ", узлов " << info.nodes << ":";
+    for (const auto& move : info.pv) line << " " << move.toString();
+    std::cout << line.str() << "\n";
+}
+
 void Game::run() {
     std::cout << "=== Шахматы ===\n";
     std::cout << "Формат хода: e2e4 или e2 e4\n";
@@ -48,7 +97,8 @@ void Game::run() {
         board_.display(flipped_);
 
         // Проверка состояния игры
-        GameState state = board_.evaluateGameState(currentTurn_);
+        bool inCheck = false;
+        GameState state = board_.evaluateGameState(currentTurn_, inCheck);
 
         switch (state) {
             case GameState::Checkmate:
@@ -64,23 +114,50 @@ void Game::run() {
             case GameState::DrawByRepetition:
                 std::cout << "Ничья по троекратному повторению позиции.\n";
                 return;
+            case GameState::DrawByInsufficientMaterial:
+                std::cout << "Ничья: недостаточно материала для мата.\n";
+                return;
             case GameState::InProgress:
                 break;
         }
 
         // Сообщение о шахе
-        if (board_.isInCheck(currentTurn_)) {
+        if (inCheck) {
             std::cout << "Шах!\n";
         }
 
         // Ход AI
         if (isAiTurn()) {
+            // Ход игрока угадан — поиск идёт с его хода, дожидаемся результата
+            if (ponderHit_) {
+                ponderHit_ = false;
+                Move aiMove = ponder_.get().bestMove;
+                std::cout << "Компьютер ходит: " << aiMove.toString() << " (ход угадан)\n";
+                board_.makeMove(aiMove);
+                switchTurn();
+                startPondering();
+                continue;
+            }
+
+            // Сначала книга — в дебюте поиск не нужен
+            if (book_) {
+                if (auto bookMove = book_->probe(board_, currentTurn_, bookSelection_)) {
+                    std::cout << "Компьютер ходит: " << bookMove->toString() << " (книга)\n";
+                    board_.makeMove(*bookMove);
+                    switchTurn();
+                    continue;
+                }
+            }
+
             std::string colorName = (currentTurn_ == Color::White) ? "белые" : "чёрные";
             std::cout << "Компьютер (" << colorName << ") думает...\n";
-            Move aiMove = findBestMove(board_, currentTurn_);
+            SearchHandle handle = startSearch(board_, currentTurn_, limits_, searchOptions(),
+                                              printSearchInfo);
+            Move aiMove = handle.get().bestMove;
             std::cout << "Компьютер ходит: " << aiMove.toString() << "\n";
             board_.makeMove(aiMove);
             switchTurn();
+            startPondering();
             continue;
         }
 
@@ -153,6 +230,18 @@ void Game::run() {
             continue;
         }
 
+        // Обдумывание: при совпадении продолжаем поиск, иначе прерываем —
+        // таблица транспозиций остаётся для следующего поиска
+        if (ponder_.valid()) {
+            if (ponderMove_ && *ponderMove_ == move) {
+                ponder_.ponderhit();
+                ponderHit_ = true;
+            } else {
+                ponder_.stop();
+                ponder_.get();
+            }
+        }
+
         // Выполнение хода
         board_.makeMove(move);
         switchTurn();
@@ -1,8 +1,13 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "ai.h"
 #include "board.h"
+#include "book.h"
 #include "player.h"
+#include "tt.h"
+#include <memory>
+#include <optional>
 
 class Game {
 public:
@@ -10,6 +15,16 @@ public:
     Game(bool aiEnabled, Color aiColor);
     void run();
 
+    // Дебютная книга, которую компьютер проверяет перед поиском (nullptr — без книги)
+    void setOpeningBook(const OpeningBook* book, BookSelection selection);
+
+    // Ограничения поиска компьютера на ход
+    void setSearchLimits(const SearchLimits& limits) { limits_ = limits; }
+    // Размер таблицы транспозиций в МБ
+    void setHashSize(size_t sizeMb);
+    // Обдумывание на времени соперника
+    void setPonder(bool enabled) { ponderEnabled_ = enabled; }
+
 private:
     Board board_;
     Player whitePlayer_;
@@ -18,10 +33,23 @@ private:
     bool aiEnabled_;
     Color aiColor_;
     bool flipped_;
+    const OpeningBook* book_ = nullptr;
+    BookSelection bookSelection_ = BookSelection::WeightedRandom;
+
+    SearchLimits limits_;
+    std::unique_ptr<TranspositionTable> tt_;
+
+    // Обдумывание: поиск в позиции после ожидаемого ответа игрока
+    bool ponderEnabled_ = false;
+    SearchHandle ponder_;
+    std::optional<Move> ponderMove_;
+    bool ponderHit_ = false;
 
     Player& getCurrentPlayer();
     void switchTurn();
     bool isAiTurn() const;
+    SearchOptions searchOptions() const;
+    void startPondering();
 };
 
 #endif
@@ -1,13 +1,607 @@
 #include "game.h"
+#include "ai.h"
+#include "bench.h"
+#include "book.h"
+#include "datagen.h"
+#include "nnue.h"
+#include "match.h"
+#include "perft.h"
+#include "profile.h"
+#include "record.h"
+#include "server.h"
+#include "tablebase.h"
+#include "tbcheck.h"
+#include "nnuecheck.h"
+#include "tt.h"
+#include "tuner.h"
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <locale>
 #include <iostream>
 #include <string>
 
-int main() {
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Числовое значение параметра arg: строка целиком, в диапазоне типа value
+// (отрицательное для беззнакового — ошибка). Иначе сообщение и false.
+template <typename T>
+static bool parseNumber(const std::string& arg, const char* text, T& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    if (ptr == text || ptr != end || ec != std::errc()) {
+        std::cerr << "Ошибка: " << arg << " ожидает число, получено \"" << text << "\"\n";
+        return false;
+    }
+    return true;
+}
+
+// Режим perft: разбивка по корневым ходам, итог и скорость.
+// Код возврата 1, если итог не совпал с ожидаемым.
+static int runPerft(const std::string& fen, int depth, unsigned threads, size_t hashMb,
+                    uint64_t expected) {
+    Board board;
+    Color side;
+    std::string error;
+    if (!board.loadFen(fen, side, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    std::unique_ptr<PerftTable> table;
+    if (hashMb > 0) table = std::make_unique<PerftTable>(hashMb);
+
+    auto start = std::chrono::steady_clock::now();
+    PerftResult result = parallelPerft(board, side, depth, pool, table.get());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const auto& [move, nodes] : result.divide) {
+        std::cout << move.toString() << ": " << nodes << "\n";
+    }
+    std::cout << "\nУзлов: " << result.nodes << "\n";
+    std::cout << "Время: " << seconds << " с, потоков: " << pool.size() << "\n";
+    if (seconds > 0) {
+        std::cout << "Скорость: " << static_cast<uint64_t>(result.nodes / seconds) << " узлов/с\n";
+    }
+
+    if (expected && result.nodes != expected) {
+        std::cerr << "Ошибка perft: ожидалось " << expected << ", получено " << result.nodes << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Режим bench: воспроизводимый поиск по эталонному набору, сумма узлов и скорость.
+// Код возврата 1, если сумма не совпала с ожидаемой.
+static int runBenchMode(int depth, size_t hashMb, uint64_t expected) {
+    BenchResult result;
+    std::string error;
+    bool ok = runBench(depth, hashMb, getEvalBackend(), result, error, [](const BenchPosition& position) {
+        std::cout << position.fen << ": " << position.bestMove.toString() << ", узлов " << position.nodes
+                  << "\n";
+    });
+    if (!ok) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "\nПозиций: " << result.positions.size() << ", глубина " << depth << "\n";
+    std::cout << "Узлов: " << result.nodes << "\n";
+    std::cout << "Время: " << result.seconds << " с\n";
+    if (result.seconds > 0) {
+        std::cout << "Скорость: " << static_cast<uint64_t>(result.nodes / result.seconds) << " узлов/с\n";
+    }
+
+    if (expected && result.nodes != expected) {
+        std::cerr << "Ошибка bench: ожидалось " << expected << " узлов, получено " << result.nodes << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Режим сверки таблиц Syzygy с эталоном; код возврата 1 при расхождении
+static int runSyzygyCheck(int stride) {
+    TablebaseCheckResult result;
+    std::string error;
+    bool ok = checkTablebases(stride, result, error);
+    std::cout << "Эталонных позиций: " << result.references
+              << ", позиций проверено на согласованность: " << result.positions << "\n";
+    if (!ok) {
+        std::cerr << "Ошибка таблиц: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Таблицы совпадают с эталоном\n";
+    return 0;
+}
+
+// Самопроверка NNUE на случайной сети; код возврата 1 при расхождении
+static int runNnueCheck(int depth, uint64_t seed) {
+    NnueCheckResult result;
+    std::string error;
+    bool ok = checkNnue(depth, seed, result, error);
+    std::cout << "SIMD: " << nnueSimdName() << ", позиций проверено: " << result.positions << "\n";
+    if (!ok) {
+        std::cerr << "Ошибка NNUE: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Аккумулятор и прямой проход совпадают со скалярным пересчётом\n";
+    return 0;
+}
+
+// Режим матча: партии движков и итог с оценкой Эло первого движка
+static int runMatchMode(const MatchConfig& config, unsigned threads) {
+    ThreadPool pool(threads);
+    std::cout << "Матч: " << config.engines[0].name << " против " << config.engines[1].name
+              << ", партий: " << config.games << ", потоков: " << pool.size() << "\n";
+
+    MatchResult result;
+    std::string error;
+    if (!runMatch(config, pool, result, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    EloEstimate elo = estimateElo(result);
+    std::cout << "\n" << config.engines[0].name << ": +" << result.wins << " =" << result.draws
+              << " -" << result.losses << "\n";
+    std::cout << "Эло: " << elo.elo << " ± " << elo.margin << " (95%)\n";
+    for (int i = 0; i < 2; ++i) {
+        double nps = result.searchSeconds[i] > 0 ? result.nodes[i] / result.searchSeconds[i] : 0;
+        std::cout << config.engines[i].name << ": " << result.nodes[i] << " узлов, "
+                  << static_cast<uint64_t>(nps) << " узлов/с\n";
+    }
+    return 0;
+}
+
+// Режим анализа: лучшие линии позиции по итерациям
+static int runAnalysis(const std::string& fen, const SearchLimits& limits, int multiPv,
+                       size_t hashMb) {
+    Board board;
+    Color side;
+    std::string error;
+    if (!board.loadFen(fen, side, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    TranspositionTable tt(hashMb > 0 ? hashMb : 16);
+    SearchOptions options;
+    options.backend = getEvalBackend();
+    options.tt = &tt;
+    options.multiPv = multiPv;
+
+    SearchResult result = search(board, side, limits, options, nullptr, [](const SearchInfo& info) {
+        std::cout << "глубина " << info.depth << " #" << info.multiPv << " оценка " << info.score
+                  << " узлов " << info.nodes << ":";
+        for (const auto& move : info.pv) std::cout << " " << move.toString();
+        std::cout << "\n";
+    });
+
+    std::cout << "\nЛучший ход: " << result.bestMove.toString() << "\n";
+    std::cout << "Фигур из пула: " << result.pieceAllocations << " (пополнений пула: "
+              << result.poolRefills << ")";
+    if (PROFILE_ENABLED) std::cout << ", выделений в куче: " << result.heapAllocations;
+    std::cout << "\n";
+    return 0;
+}
+
+// Упаковка списка FEN в файл записей позиций
+static int runPackFens(const std::string& input, const std::string& output) {
+    std::vector<std::string> fens;
+    std::string error;
+    if (!loadOpenings(input, fens, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    RecordWriter writer;
+    if (!writer.open(output, RecordKind::Positions, sizeof(PackedPosition), error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+    Board board;
+    for (const auto& fen : fens) {
+        Color side;
+        PackedPosition packed;
+        if (!board.loadFen(fen, side, error) || !packPosition(board, side, packed)) {
+            std::cerr << "Пропущена позиция: " << fen << "\n";
+            continue;
+        }
+        writer.append(&packed, sizeof(packed));
+    }
+    uint64_t count = writer.count();
+    if (!writer.close(error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Записано позиций: " << count << " в " << output << "\n";
+    return 0;
+}
+
+static std::string fullFen(const Board& board, Color side) {
+    return board.getPositionKey(side) + " " + std::to_string(board.getHalfmoveClock()) + " 1";
+}
+
+// Вывод файла записей: позиции — FEN, партии — начальный FEN, ходы и результат,
+// обучающие примеры — FEN, оценка и результат
+static int runDumpRecords(const std::string& path) {
+    RecordFile file;
+    std::string error;
+    if (!file.open(path, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+
+    Board board;
+    Color side;
+    for (uint64_t i = 0; i < file.size(); ++i) {
+        size_t size;
+        const uint8_t* data = file.record(i, size);
+        if (file.kind() == RecordKind::Samples) {
+            TrainingSample sample;
+            std::memcpy(&sample, data, sizeof(sample));
+            if (!unpackPosition(sample.position, board, side, error)) {
+                std::cerr << "Запись " << i << ": " << error << "\n";
+                return 1;
+            }
+            std::cout << fullFen(board, side) << " | " << sample.score << " | "
+                      << (sample.result > 0 ? "1-0" : sample.result < 0 ? "0-1" : "1/2-1/2") << "\n";
+        } else if (file.kind() == RecordKind::Positions) {
+            PackedPosition packed;
+            std::memcpy(&packed, data, sizeof(packed));
+            if (!unpackPosition(packed, board, side, error)) {
+                std::cerr << "Запись " << i << ": " << error << "\n";
+                return 1;
+            }
+            std::cout << fullFen(board, side) << "\n";
+        } else {
+            PackedGame game;
+            if (!readGame(data, size, game, error) || !unpackPosition(game.start, board, side, error)) {
+                std::cerr << "Запись " << i << ": " << error << "\n";
+                return 1;
+            }
+            std::cout << "[" << fullFen(board, side) << "]";
+            for (uint16_t move : game.moves) std::cout << " " << decodeMove(move).toString();
+            std::cout << " " << (game.result > 0 ? "1-0" : game.result < 0 ? "0-1" : "1/2-1/2") << "\n";
+        }
+    }
+    return 0;
+}
+
+// Генерация обучающих данных партиями движка с самим собой
+static int runDatagen(const DatagenConfig& config, unsigned threads) {
+    ThreadPool pool(threads);
+    std::cout << "Генерация: " << config.positions << " позиций, " << config.nodes
+              << " узлов на ход, потоков: " << pool.size() << "\n";
+
+    auto start = std::chrono::steady_clock::now();
+    DatagenStats stats;
+    std::string error;
+    if (!generateTrainingData(config, pool, stats, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nЗаписано позиций: " << stats.positions << " из " << stats.games << " партий в "
+              << config.outputPath << "\n";
+    if (seconds > 0) {
+        std::cout << "Скорость: " << static_cast<uint64_t>(stats.positions / seconds * 3600)
+                  << " позиций/ч\n";
+    }
+    return 0;
+}
+
+// Настройка параметров оценки по обучающим примерам; результат — файл параметров
+static int runTuner(const TunerConfig& config, const std::string& output, unsigned threads) {
+    ThreadPool pool(threads);
+    std::cout << "Настройка: " << config.dataPath << ", шагов: " << config.iterations
+              << ", потоков: " << pool.size() << "\n";
+
+    EvalParams params = currentEvalParams();
+    std::string error;
+    if (!tuneEvalParams(config, pool, params, error) || !saveEvalParams(params, output, error)) {
+        std::cerr << "Ошибка: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Параметры записаны в " << output << "\n";
+    return 0;
+}
+
+// Формат счётчиков профилирования при выходе (make PROFILE=1)
+static bool profileJson = false;
+
+static void dumpProfileAtExit() {
+    dumpProfile(std::cerr, profileJson);
+}
+
+int main(int argc, char* argv[]) {
     // Установка локали для корректного отображения Unicode-символов
     std::locale::global(std::locale(""));
     std::cout.imbue(std::locale());
 
+    // Параметры командной строки:
+    //   --nnue <файл>     загрузить сеть NNUE и оценивать ею
+    //   --eval pst|nnue   выбрать оценку явно
+    //   --eval-params <файл>  параметры PST-оценки (например, результат --tune)
+    //   --book <файл>     дебютная книга Polyglot (.bin)
+    //   --book-best       брать из книги ход с наибольшим весом (по умолчанию — случайный по весам)
+    //   --depth N         глубина поиска компьютера (по умолчанию 4)
+    //   --movetime N      время компьютера на ход в мс (0 — без ограничения)
+    //   --hash N          таблица транспозиций компьютера в МБ
+    //   --huge-pages off|thp|explicit  страницы памяти таблиц транспозиций (по умолчанию thp)
+    //   --ponder          думать на времени соперника
+    //   --syzygy <пути>   каталоги с таблицами Syzygy через ':'
+    //   --syzygy-depth N  минимальная глубина для проб в поиске
+    //   --syzygy-limit N  максимум фигур для проб
+    //   --syzygy-check N  сверить таблицы 3 фигур с эталоном (каждую N-ю позицию) и выйти
+    //   --nnue-check N    сверить NNUE на случайной сети (ходы до глубины N) и выйти
+    //   --analyze         анализ позиции --fen с --depth/--movetime и выход
+    //   --multipv N       число лучших линий в анализе
+    //   --perft N         посчитать perft глубины N и выйти
+    //   --fen <FEN>       позиция для perft и анализа (по умолчанию — начальная)
+    //   --threads N       число потоков (0 — все ядра)
+    //   --perft-hash N    размер таблицы поддеревьев perft в МБ (0 — без неё)
+    //   --perft-expect N  ожидаемое число узлов; при несовпадении код возврата 1
+    //   --bench N         воспроизводимый поиск глубины N по эталонным позициям и выход
+    //   --bench-expect N  ожидаемая сумма узлов bench; при несовпадении код возврата 1
+    //   --match N         сыграть N партий движок против движка и выйти
+    //   --engine1 <опции> первый движок: "depth=3,time=100,nodes=0,eval=pst,hash=16,name=A"
+    //   --engine2 <опции> второй движок
+    //   --openings <файл> дебютные позиции (FEN построчно)
+    //   --max-plies N     ничья по присуждению после N полуходов
+    //   --save-games <файл>  сохранить партии матча в файл записей
+    //   --pack-fens <файл> упаковать FEN из файла в файл записей --output и выйти
+    //   --output <файл>   файл результата
+    //   --dump-records <файл>  вывести файл записей (позиции или партии) и выйти
+    //   --datagen N       записать N обучающих позиций из партий с собой в --output и выйти
+    //   --datagen-nodes N узлов поиска на ход при генерации
+    //   --datagen-random N  случайных полуходов в начале каждой партии
+    //   --seed N          начальное значение генератора случайных чисел
+    //   --tune <файл>     настроить параметры оценки по обучающим примерам, записать в --output и выйти
+    //   --tune-iters N    шагов градиентного спуска
+    //   --tune-rate X     шаг спуска в сантипешках
+    //   --tune-limit N    использовать не больше N позиций
+    //   --profile-json    счётчики профилирования при выходе в JSON, а не таблицей
+    //                     (только в сборке make PROFILE=1)
+    //   --server          сервер многих партий на stdin/stdout (протокол — в server.h)
+    //   --server-socket <путь>  то же на Unix-сокете
+    //   --shared-hash N   общая таблица транспозиций сервера в МБ (по умолчанию — своя у сессии)
+    //   --server-max-time N  потолок времени одного поиска сервера в мс (делится между сессиями)
+    OpeningBook book;
+    BookSelection bookSelection = BookSelection::WeightedRandom;
+    TablebaseConfig tbConfig;
+    SearchLimits gameLimits;
+    size_t hashMb = 0;
+    bool ponder = false;
+    std::string fen = START_FEN;
+    int perftDepth = 0;
+    unsigned threads = 0;
+    size_t perftHashMb = 64;
+    uint64_t perftExpected = 0;
+    int benchDepth = 0;
+    int syzygyCheckStride = 0;
+    int nnueCheckDepth = -1;
+    uint64_t benchExpected = 0;
+    MatchConfig match;
+    bool analyze = false;
+    int multiPv = 1;
+    DatagenConfig datagen;
+    bool datagenMode = false;
+    TunerConfig tuner;
+    std::string packFens;
+    std::string output;
+    std::string dumpRecords;
+    bool serverMode = false;
+    std::string serverSocket;
+    size_t sharedHashMb = 0;
+    int64_t serverMaxMs = 0;
+    match.games = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--nnue" && i + 1 < argc) {
+            std::string error;
+            if (!loadNnue(argv[++i], error)) {
+                std::cerr << "Ошибка загрузки NNUE: " << error << "\n";
+                return 1;
+            }
+            setEvalBackend(EvalBackend::Nnue);
+        } else if (arg == "--eval-params" && i + 1 < argc) {
+            EvalParams params = defaultEvalParams();
+            std::string error;
+            if (!loadEvalParams(argv[++i], params, error)) {
+                std::cerr << "Ошибка загрузки параметров оценки: " << error << "\n";
+                return 1;
+            }
+            setEvalParams(params);
+        } else if (arg == "--eval" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend != "pst" && backend != "nnue") {
+                std::cerr << "Ошибка: --eval pst|nnue\n";
+                return 1;
+            }
+            setEvalBackend(backend == "nnue" ? EvalBackend::Nnue : EvalBackend::Pst);
+        } else if (arg == "--book" && i + 1 < argc) {
+            std::string error;
+            if (!book.open(argv[++i], error)) {
+                std::cerr << "Ошибка загрузки книги: " << error << "\n";
+                return 1;
+            }
+        } else if (arg == "--book-best") {
+            bookSelection = BookSelection::Best;
+        } else if (arg == "--depth" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], gameLimits.depth)) return 1;
+        } else if (arg == "--movetime" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], gameLimits.timeMs)) return 1;
+        } else if (arg == "--hash" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], hashMb)) return 1;
+        } else if (arg == "--huge-pages" && i + 1 < argc) {
+            std::string pages = argv[++i];
+            if (pages == "off") setTtPages(TtPages::Normal);
+            else if (pages == "thp") setTtPages(TtPages::Transparent);
+            else if (pages == "explicit") setTtPages(TtPages::Explicit);
+            else {
+                std::cerr << "Ошибка: --huge-pages off|thp|explicit\n";
+                return 1;
+            }
+        } else if (arg == "--ponder") {
+            ponder = true;
+        } else if (arg == "--syzygy" && i + 1 < argc) {
+            int found = initTablebases(argv[++i]);
+            std::cout << "Таблиц Syzygy найдено: " << found
+                      << " (до " << tablebaseMaxPieces() << " фигур)\n";
+        } else if (arg == "--syzygy-depth" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], tbConfig.probeDepth)) return 1;
+        } else if (arg == "--syzygy-limit" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], tbConfig.pieceLimit)) return 1;
+        } else if (arg == "--syzygy-check" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], syzygyCheckStride)) return 1;
+        } else if (arg == "--nnue-check" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], nnueCheckDepth)) return 1;
+        } else if (arg == "--perft" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], perftDepth)) return 1;
+        } else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], threads)) return 1;
+        } else if (arg == "--perft-hash" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], perftHashMb)) return 1;
+        } else if (arg == "--perft-expect" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], perftExpected)) return 1;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], benchDepth)) return 1;
+        } else if (arg == "--bench-expect" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], benchExpected)) return 1;
+        } else if (arg == "--match" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], match.games)) return 1;
+        } else if ((arg == "--engine1" || arg == "--engine2") && i + 1 < argc) {
+            std::string error;
+            if (!parseEngineConfig(argv[++i], match.engines[arg == "--engine1" ? 0 : 1], error)) {
+                std::cerr << "Ошибка в " << arg << ": " << error << "\n";
+                return 1;
+            }
+        } else if (arg == "--openings" && i + 1 < argc) {
+            std::string error;
+            if (!loadOpenings(argv[++i], match.openings, error)) {
+                std::cerr << "Ошибка загрузки дебютов: " << error << "\n";
+                return 1;
+            }
+        } else if (arg == "--analyze") {
+            analyze = true;
+        } else if (arg == "--multipv" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], multiPv)) return 1;
+        } else if (arg == "--save-games" && i + 1 < argc) {
+            match.gamesPath = argv[++i];
+        } else if (arg == "--pack-fens" && i + 1 < argc) {
+            packFens = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--dump-records" && i + 1 < argc) {
+            dumpRecords = argv[++i];
+        } else if (arg == "--datagen" && i + 1 < argc) {
+            datagenMode = true;
+            if (!parseNumber(arg, argv[++i], datagen.positions)) return 1;
+        } else if (arg == "--datagen-nodes" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], datagen.nodes)) return 1;
+        } else if (arg == "--datagen-random" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], datagen.randomPlies)) return 1;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], datagen.seed)) return 1;
+        } else if (arg == "--tune" && i + 1 < argc) {
+            tuner.dataPath = argv[++i];
+        } else if (arg == "--tune-iters" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], tuner.iterations)) return 1;
+        } else if (arg == "--tune-rate" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], tuner.learningRate)) return 1;
+        } else if (arg == "--tune-limit" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], tuner.maxPositions)) return 1;
+        } else if (arg == "--profile-json") {
+            profileJson = true;
+        } else if (arg == "--server") {
+            serverMode = true;
+        } else if (arg == "--server-socket" && i + 1 < argc) {
+            serverMode = true;
+            serverSocket = argv[++i];
+        } else if (arg == "--server-max-time" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], serverMaxMs)) return 1;
+        } else if (arg == "--shared-hash" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], sharedHashMb)) return 1;
+        } else if (arg == "--max-plies" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], match.maxPlies)) return 1;
+        } else {
+            std::cerr << "Неизвестный параметр: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // Сеть может идти в параметрах и после --eval, поэтому проверяем здесь
+    if (getEvalBackend() == EvalBackend::Nnue && !isNnueLoaded()) {
+        std::cerr << "Ошибка: --eval nnue без загруженной сети (--nnue <файл>)\n";
+        return 1;
+    }
+    setTablebaseConfig(tbConfig);
+    if (PROFILE_ENABLED) std::atexit(dumpProfileAtExit);
+
+    if (perftDepth > 0) {
+        return runPerft(fen, perftDepth, threads, perftHashMb, perftExpected);
+    }
+    if (syzygyCheckStride > 0) {
+        return runSyzygyCheck(syzygyCheckStride);
+    }
+    if (nnueCheckDepth >= 0) {
+        return runNnueCheck(nnueCheckDepth, datagen.seed);
+    }
+    if (benchDepth > 0) {
+        return runBenchMode(benchDepth, hashMb > 0 ? hashMb : 16, benchExpected);
+    }
+    if (!packFens.empty()) {
+        if (output.empty()) {
+            std::cerr << "Ошибка: для --pack-fens нужен --output\n";
+            return 1;
+        }
+        return runPackFens(packFens, output);
+    }
+    if (datagenMode) {
+        if (output.empty()) {
+            std::cerr << "Ошибка: для --datagen нужен --output\n";
+            return 1;
+        }
+        datagen.outputPath = output;
+        datagen.backend = getEvalBackend();
+        if (hashMb > 0) datagen.hashMb = hashMb;
+        return runDatagen(datagen, threads);
+    }
+    if (!tuner.dataPath.empty()) {
+        if (output.empty()) {
+            std::cerr << "Ошибка: для --tune нужен --output\n";
+            return 1;
+        }
+        return runTuner(tuner, output, threads);
+    }
+    if (!dumpRecords.empty()) {
+        return runDumpRecords(dumpRecords);
+    }
+    if (analyze) {
+        return runAnalysis(fen, gameLimits, multiPv, hashMb);
+    }
+    if (serverMode) {
+        ServerConfig config;
+        config.threads = threads;
+        config.sharedHashMb = sharedHashMb;
+        if (hashMb > 0) config.sessionHashMb = hashMb;
+        config.defaultLimits = gameLimits;
+        if (serverMaxMs > 0) config.maxSearchMs = serverMaxMs;
+        return serverSocket.empty() ? runServerStdio(config) : runServerSocket(config, serverSocket);
+    }
+    if (match.games > 0) {
+        for (int e = 0; e < 2; ++e) {
+            if (match.engines[e].name.empty()) match.engines[e].name = e == 0 ? "engine1" : "engine2";
+        }
+        return runMatchMode(match, threads);
+    }
+
     std::cout << "=== Выберите режим игры ===\n";
     std::cout << "1. Игрок vs Игрок\n";
     std::cout << "2. Игрок vs Компьютер\n";
@@ -27,6 +621,10 @@ int main() {
 
         Color aiColor = (colorChoice == "2") ? Color::White : Color::Black;
         Game game(true, aiColor);
+        if (book.isOpen()) game.setOpeningBook(&book, bookSelection);
+        game.setSearchLimits(gameLimits);
+        if (hashMb > 0) game.setHashSize(hashMb);
+        game.setPonder(ponder);
         game.run();
     } else {
         Game game;
@@ -0,0 +1,234 @@
+#include "match.h"
+#include "nnue.h"
+#include "record.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+static const char* START_POSITION = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+bool parseEngineConfig(const std::string& spec, EngineConfig& config, std::string& error) {
+    std::istringstream iss(spec);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (item.empty()) continue;
+        auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            error = "ожидалось ключ=значение: " + item;
+            return false;
+        }
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+        try {
+            if (key == "depth") {
+                config.limits.depth = std::stoi(value);
+            } else if (key == "time") {
+                config.limits.timeMs = std::stoll(value);
+            } else if (key == "nodes") {
+                config.limits.nodes = std::stoull(value);
+            } else if (key == "eval") {
+                if (value != "pst" && value != "nnue") {
+                    error = "неизвестная оценка: " + value;
+                    return false;
+                }
+                config.backend = (value == "nnue") ? EvalBackend::Nnue : EvalBackend::Pst;
+            } else if (key == "hash") {
+                config.hashMb = std::stoull(value);
+            } else if (key == "name") {
+                config.name = value;
+            } else {
+                error = "неизвестный параметр движка: " + key;
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "неверное значение: " + item;
+            return false;
+        }
+    }
+    if (config.name.empty()) config.name = spec.empty() ? "default" : spec;
+    return true;
+}
+
+bool loadOpenings(const std::string& path, std::vector<std::string>& openings, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        auto last = line.find_last_not_of(" \t\r");
+        openings.push_back(line.substr(first, last - first + 1));
+    }
+    if (openings.empty()) {
+        error = "в файле нет позиций: " + path;
+        return false;
+    }
+    return true;
+}
+
+// Итог одной партии с точки зрения первого движка
+struct GameRecord {
+    int score = 0; // 1 — победа, 0 — ничья, -1 — поражение
+    GameState state = GameState::InProgress;
+    int plies = 0;
+    uint64_t nodes[2] = {0, 0};
+    double searchSeconds[2] = {0, 0};
+    PackedGame packed; // для сохранения партии
+};
+
+static GameRecord playGame(const MatchConfig& config, const std::string& fen, bool firstIsWhite) {
+    GameRecord record;
+    Board board;
+    Color side;
+    std::string error;
+    board.loadFen(fen, side, error); // корректность проверена в runMatch
+    packPosition(board, side, record.packed.start);
+
+    std::unique_ptr<TranspositionTable> tables[2];
+    SearchOptions options[2];
+    for (int i = 0; i < 2; ++i) {
+        if (config.engines[i].hashMb > 0) {
+            tables[i] = std::make_unique<TranspositionTable>(config.engines[i].hashMb);
+        }
+        options[i].backend = config.engines[i].backend;
+        options[i].tt = tables[i].get();
+    }
+
+    while (true) {
+        // Присуждение — по правилам игры: мат, пат, 50 ходов, повторение
+        record.state = board.evaluateGameState(side);
+        if (record.state == GameState::Checkmate) {
+            bool firstToMove = (side == Color::White) == firstIsWhite;
+            record.score = firstToMove ? -1 : 1;
+            record.packed.result = side == Color::White ? -1 : 1;
+            return record;
+        }
+        if (record.state != GameState::InProgress) return record;
+        if (record.plies >= config.maxPlies) return record;
+
+        int engine = ((side == Color::White) == firstIsWhite) ? 0 : 1;
+        SearchResult sr = search(board, side, config.engines[engine].limits, options[engine]);
+        record.nodes[engine] += sr.nodes;
+        record.searchSeconds[engine] += sr.seconds;
+
+        board.makeMove(sr.bestMove);
+        record.packed.moves.push_back(encodeMove(sr.bestMove));
+        side = oppositeColor(side);
+        record.plies++;
+    }
+}
+
+static const char* describeOutcome(const GameRecord& record) {
+    switch (record.state) {
+        case GameState::Checkmate:                  return "мат";
+        case GameState::Stalemate:                  return "пат";
+        case GameState::DrawBy50Moves:              return "правило 50 ходов";
+        case GameState::DrawByRepetition:           return "троекратное повторение";
+        case GameState::DrawByInsufficientMaterial: return "недостаточно материала";
+        case GameState::InProgress:                 return "лимит ходов";
+    }
+    return "";
+}
+
+bool runMatch(const MatchConfig& config, ThreadPool& pool, MatchResult& result, std::string& error) {
+    // Без сети NNUE оценка молча стала бы PST — такой матч сравнивал бы не то
+    for (const auto& engine : config.engines) {
+        if (engine.backend == EvalBackend::Nnue && !isNnueLoaded()) {
+            error = "движок " + engine.name + ": eval=nnue без загруженной сети (--nnue <файл>)";
+            return false;
+        }
+    }
+
+    std::vector<std::string> openings = config.openings;
+    if (openings.empty()) openings.push_back(START_POSITION);
+
+    for (const auto& fen : openings) {
+        Board board;
+        Color side;
+        if (!board.loadFen(fen, side, error)) return false;
+    }
+
+    RecordWriter gamesFile;
+    if (!config.gamesPath.empty() && !gamesFile.open(config.gamesPath, RecordKind::Games, 0, error)) {
+        return false;
+    }
+
+    std::mutex resultMutex;
+    int finished = 0;
+    bool writeFailed = false;
+
+    for (int game = 0; game < config.games; ++game) {
+        const std::string& fen = openings[(game / 2) % openings.size()];
+        bool firstIsWhite = (game % 2 == 0);
+
+        pool.submit([&, game, fen, firstIsWhite]() {
+            GameRecord record = playGame(config, fen, firstIsWhite);
+
+            std::vector<uint8_t> bytes;
+            if (!config.gamesPath.empty()) appendGame(record.packed, bytes);
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (!bytes.empty() && !gamesFile.append(bytes.data(), bytes.size())) writeFailed = true;
+            if (record.score > 0) result.wins++;
+            else if (record.score < 0) result.losses++;
+            else result.draws++;
+            for (int i = 0; i < 2; ++i) {
+                result.nodes[i] += record.nodes[i];
+                result.searchSeconds[i] += record.searchSeconds[i];
+            }
+
+            finished++;
+            const char* white = config.engines[firstIsWhite ? 0 : 1].name.c_str();
+            const char* black = config.engines[firstIsWhite ? 1 : 0].name.c_str();
+            const char* score = record.score == 0 ? "1/2-1/2"
+                              : (record.score > 0) == firstIsWhite ? "1-0" : "0-1";
+            std::cout << "Партия " << game + 1 << " (" << finished << "/" << config.games << "): "
+                      << white << " - " << black << " " << score
+                      << " (" << describeOutcome(record) << ", " << record.plies << " полуходов)"
+                      << "  счёт +" << result.wins << " =" << result.draws << " -" << result.losses
+                      << std::endl;
+        });
+    }
+    pool.waitIdle();
+
+    if (!config.gamesPath.empty()) {
+        if (!gamesFile.close(error)) return false;
+        if (writeFailed) {
+            error = "не все партии записаны в " + config.gamesPath;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Elo по доле набранных очков: p = 1 / (1 + 10^(-elo/400))
+static double eloFromScore(double p) {
+    p = std::clamp(p, 1e-6, 1 - 1e-6);
+    return -400.0 * std::log10(1.0 / p - 1.0);
+}
+
+EloEstimate estimateElo(const MatchResult& result) {
+    EloEstimate estimate;
+    int n = result.games();
+    if (n == 0) return estimate;
+
+    double w = double(result.wins) / n;
+    double d = double(result.draws) / n;
+    double l = double(result.losses) / n;
+    double p = w + d / 2;
+
+    // Дисперсия очков за партию и 95% интервал доли очков
+    double variance = w * (1 - p) * (1 - p) + d * (0.5 - p) * (0.5 - p) + l * p * p;
+    double delta = 1.959964 * std::sqrt(variance / n);
+
+    estimate.elo = eloFromScore(p);
+    estimate.margin = (eloFromScore(p + delta) - eloFromScore(p - delta)) / 2;
+    return estimate;
+}
@@ -0,0 +1,56 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "ai.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Матч движок против движка без участия человека.
+// Каждый дебют играется дважды со сменой цветов.
+
+struct EngineConfig {
+    std::string name;
+    SearchLimits limits;
+    EvalBackend backend = EvalBackend::Pst;
+    size_t hashMb = 0; // таблица транспозиций на партию; 0 — без неё
+};
+
+// Разбор описания движка вида "depth=3,time=100,nodes=0,eval=nnue,hash=16"
+bool parseEngineConfig(const std::string& spec, EngineConfig& config, std::string& error);
+
+struct MatchConfig {
+    EngineConfig engines[2];
+    int games = 2;
+    std::vector<std::string> openings; // FEN; пусто — начальная позиция
+    int maxPlies = 400;                // дольше — ничья по присуждению
+    std::string gamesPath;             // непусто — сохранить партии в файл записей (record.h)
+};
+
+// Загрузка дебютов: по одному FEN в строке, '#' — комментарий
+bool loadOpenings(const std::string& path, std::vector<std::string>& openings, std::string& error);
+
+struct MatchResult {
+    int wins = 0;   // с точки зрения первого движка
+    int draws = 0;
+    int losses = 0;
+    uint64_t nodes[2] = {0, 0};
+    double searchSeconds[2] = {0, 0};
+
+    int games() const { return wins + draws + losses; }
+};
+
+// Разница в рейтинге Эло по результату и полуширина 95% доверительного интервала
+struct EloEstimate {
+    double elo = 0;
+    double margin = 0;
+};
+EloEstimate estimateElo(const MatchResult& result);
+
+// Партии играются параллельно на пуле, каждая — в одном потоке.
+// Возвращает false и error, если дебютная позиция некорректна или движку
+// нужна NNUE, а сеть не загружена.
+bool runMatch(const MatchConfig& config, ThreadPool& pool, MatchResult& result, std::string& error);
+
+#endif
@@ -21,6 +21,10 @@ struct Move {
     Square to;
     char promotion = '\0'; // 'q', 'r', 'b', 'n' или '\0'
 
+    bool operator==(const Move& other) const {
+        return from == other.from && to == other.to && promotion == other.promotion;
+    }
+    bool operator!=(const Move& other) const { return !(*this == other); }
     std::string toString() const;
 };
 
@@ -0,0 +1,332 @@
+#include "nnue.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// Квантование: веса скрытых слоёв масштабированы на 2^6,
+// выход сети — на OUTPUT_SCALE относительно сантипешек
+static const int WEIGHT_SHIFT = 6;
+static const int OUTPUT_SCALE = 16;
+static const int CLIP_MAX = 127;
+
+static const char NNUE_MAGIC[4] = {'C', 'V', 'N', 'N'};
+static const uint32_t NNUE_VERSION = 1;
+
+struct NnueNetwork {
+    std::vector<int16_t> ftBias;     // [HALF]
+    std::vector<int16_t> ftWeights;  // [INPUTS][HALF] — столбец признака непрерывен
+    std::vector<int32_t> l1Bias;     // [HIDDEN]
+    std::vector<int8_t> l1Weights;   // [HIDDEN][2 * HALF]
+    std::vector<int32_t> l2Bias;     // [HIDDEN]
+    std::vector<int8_t> l2Weights;   // [HIDDEN][HIDDEN]
+    int32_t outBias = 0;
+    std::vector<int8_t> outWeights;  // [HIDDEN]
+};
+
+static std::unique_ptr<NnueNetwork> network;
+
+template <typename T>
+static bool readArray(std::ifstream& in, std::vector<T>& v, size_t count) {
+    v.resize(count);
+    in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+// Формат файла (little-endian): "CVNN", версия, размеры слоёв,
+// затем массивы в порядке полей NnueNetwork
+bool loadNnue(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t header[4];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || std::memcmp(magic, NNUE_MAGIC, sizeof(magic)) != 0) {
+        error = "неверный формат файла сети";
+        return false;
+    }
+    if (header[0] != NNUE_VERSION || header[1] != NNUE_INPUTS ||
+        header[2] != NNUE_HALF_DIMENSIONS || header[3] != NNUE_HIDDEN) {
+        error = "несовместимая архитектура сети";
+        return false;
+    }
+
+    auto net = std::make_unique<NnueNetwork>();
+    bool ok = readArray(in, net->ftBias, NNUE_HALF_DIMENSIONS) &&
+              readArray(in, net->ftWeights, size_t(NNUE_INPUTS) * NNUE_HALF_DIMENSIONS) &&
+              readArray(in, net->l1Bias, NNUE_HIDDEN) &&
+              readArray(in, net->l1Weights, size_t(NNUE_HIDDEN) * 2 * NNUE_HALF_DIMENSIONS) &&
+              readArray(in, net->l2Bias, NNUE_HIDDEN) &&
+              readArray(in, net->l2Weights, size_t(NNUE_HIDDEN) * NNUE_HIDDEN);
+    if (ok) {
+        in.read(reinterpret_cast<char*>(&net->outBias), sizeof(net->outBias));
+        ok = static_cast<bool>(in) && readArray(in, net->outWeights, NNUE_HIDDEN);
+    }
+    if (!ok || in.peek() != std::ifstream::traits_type::eof()) {
+        error = "неверный размер файла сети";
+        return false;
+    }
+
+    network = std::move(net);
+    return true;
+}
+
+template <typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& v) {
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+template <typename T>
+static std::vector<T> randomArray(std::mt19937_64& rng, size_t count, int lo, int hi) {
+    std::uniform_int_distribution<int> dist(lo, hi);
+    std::vector<T> v(count);
+    for (auto& x : v) x = static_cast<T>(dist(rng));
+    return v;
+}
+
+bool writeRandomNnue(const std::string& path, uint64_t seed, std::string& error) {
+    // Диапазоны подобраны так, чтобы clipped ReLU срезал значения с обеих сторон,
+    // а int8-веса занимали весь диапазон (крайний случай для maddubs)
+    std::mt19937_64 rng(seed);
+    NnueNetwork net;
+    net.ftBias = randomArray<int16_t>(rng, NNUE_HALF_DIMENSIONS, -32, 96);
+    net.ftWeights = randomArray<int16_t>(rng, size_t(NNUE_INPUTS) * NNUE_HALF_DIMENSIONS, -12, 12);
+    net.l1Bias = randomArray<int32_t>(rng, NNUE_HIDDEN, -4096, 4096);
+    net.l1Weights = randomArray<int8_t>(rng, size_t(NNUE_HIDDEN) * 2 * NNUE_HALF_DIMENSIONS, -128, 127);
+    net.l2Bias = randomArray<int32_t>(rng, NNUE_HIDDEN, -4096, 4096);
+    net.l2Weights = randomArray<int8_t>(rng, size_t(NNUE_HIDDEN) * NNUE_HIDDEN, -128, 127);
+    net.outBias = std::uniform_int_distribution<int32_t>(-1024, 1024)(rng);
+    net.outWeights = randomArray<int8_t>(rng, NNUE_HIDDEN, -128, 127);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "не удалось создать " + path;
+        return false;
+    }
+    uint32_t header[4] = {NNUE_VERSION, NNUE_INPUTS, NNUE_HALF_DIMENSIONS, NNUE_HIDDEN};
+    out.write(NNUE_MAGIC, sizeof(NNUE_MAGIC));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeArray(out, net.ftBias);
+    writeArray(out, net.ftWeights);
+    writeArray(out, net.l1Bias);
+    writeArray(out, net.l1Weights);
+    writeArray(out, net.l2Bias);
+    writeArray(out, net.l2Weights);
+    out.write(reinterpret_cast<const char*>(&net.outBias), sizeof(net.outBias));
+    writeArray(out, net.outWeights);
+    if (!out) {
+        error = "ошибка записи " + path;
+        return false;
+    }
+    return true;
+}
+
+bool isNnueLoaded() {
+    return network != nullptr;
+}
+
+int nnueFeatureIndex(Color perspective, int kingSq, Color pieceColor, PieceType type, int sq) {
+    // Для чёрных доска отражается по горизонтали — сеть видит позицию «своими глазами»
+    if (perspective == Color::Black) {
+        kingSq ^= 56;
+        sq ^= 56;
+    }
+    int pieceIndex = static_cast<int>(type) * 2 + (pieceColor == perspective ? 0 : 1);
+    return (kingSq * 10 + pieceIndex) * 64 + sq;
+}
+
+// --- Обновление аккумулятора ---
+
+const char* nnueSimdName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE4_1__)
+    return "SSE4.1";
+#else
+    return "нет";
+#endif
+}
+
+void nnueAddFeatureScalar(int16_t* acc, int feature) {
+    const int16_t* w = &network->ftWeights[size_t(feature) * NNUE_HALF_DIMENSIONS];
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        acc[i] = static_cast<int16_t>(acc[i] + w[i]);
+    }
+}
+
+void nnueAddFeature(int16_t* acc, int feature) {
+    const int16_t* w = &network->ftWeights[size_t(feature) * NNUE_HALF_DIMENSIONS];
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, b));
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        acc[i] = static_cast<int16_t>(acc[i] + w[i]);
+    }
+#endif
+}
+
+void nnueSubFeature(int16_t* acc, int feature) {
+    const int16_t* w = &network->ftWeights[size_t(feature) * NNUE_HALF_DIMENSIONS];
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, b));
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        acc[i] = static_cast<int16_t>(acc[i] - w[i]);
+    }
+#endif
+}
+
+void nnueResetPerspective(int16_t* acc) {
+    std::memcpy(acc, network->ftBias.data(), NNUE_HALF_DIMENSIONS * sizeof(int16_t));
+}
+
+// --- Прямой проход ---
+
+// Clipped ReLU: int16 -> [0, 127] в uint8
+static void clippedReluScalar(const int16_t* in, uint8_t* out, int n) {
+    for (int i = 0; i < n; ++i) {
+        out[i] = static_cast<uint8_t>(std::clamp<int>(in[i], 0, CLIP_MAX));
+    }
+}
+
+static void clippedRelu(const int16_t* in, uint8_t* out, int n) {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        // packs чередует 128-битные половины, permute возвращает порядок
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+#elif defined(__SSE4_1__)
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        __m128i packed = _mm_max_epi8(_mm_packs_epi16(a, b), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#else
+    clippedReluScalar(in, out, n);
+#endif
+}
+
+// Скалярное произведение uint8 × int8, n кратно 32.
+// maddubs не насыщается: входы ограничены 127, поэтому |a*b + c*d| < 32768.
+static int32_t dotProductScalar(const uint8_t* input, const int8_t* weights, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<int32_t>(input[i]) * weights[i];
+    }
+    return sum;
+}
+
+static int32_t dotProduct(const uint8_t* input, const int8_t* weights, int n) {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    return dotProductScalar(input, weights, n);
+#endif
+}
+
+// Полносвязный слой с clipped ReLU на выходе; Scalar — без SIMD
+template <bool Scalar>
+static void affineRelu(const uint8_t* input, int inSize, const int8_t* weights,
+                       const int32_t* bias, uint8_t* out, int outSize) {
+    for (int o = 0; o < outSize; ++o) {
+        const int8_t* row = weights + size_t(o) * inSize;
+        int32_t dot = Scalar ? dotProductScalar(input, row, inSize) : dotProduct(input, row, inSize);
+        int32_t v = (bias[o] + dot) >> WEIGHT_SHIFT;
+        out[o] = static_cast<uint8_t>(std::clamp<int32_t>(v, 0, CLIP_MAX));
+    }
+}
+
+template <bool Scalar>
+static int forward(const NnueAccumulator& acc) {
+    const NnueNetwork& net = *network;
+
+    // Вход второго слоя: [перспектива белых, перспектива чёрных] —
+    // порядок фиксирован, поэтому выход сети всегда с точки зрения белых
+    alignas(32) uint8_t input[2 * NNUE_HALF_DIMENSIONS];
+    for (int p = 0; p < 2; ++p) {
+        uint8_t* half = input + p * NNUE_HALF_DIMENSIONS;
+        if (Scalar) {
+            clippedReluScalar(acc.values[p], half, NNUE_HALF_DIMENSIONS);
+        } else {
+            clippedRelu(acc.values[p], half, NNUE_HALF_DIMENSIONS);
+        }
+    }
+
+    alignas(32) uint8_t hidden1[NNUE_HIDDEN];
+    alignas(32) uint8_t hidden2[NNUE_HIDDEN];
+    affineRelu<Scalar>(input, 2 * NNUE_HALF_DIMENSIONS, net.l1Weights.data(), net.l1Bias.data(),
+                       hidden1, NNUE_HIDDEN);
+    affineRelu<Scalar>(hidden1, NNUE_HIDDEN, net.l2Weights.data(), net.l2Bias.data(),
+                       hidden2, NNUE_HIDDEN);
+
+    int32_t dot = Scalar ? dotProductScalar(hidden2, net.outWeights.data(), NNUE_HIDDEN)
+                         : dotProduct(hidden2, net.outWeights.data(), NNUE_HIDDEN);
+    return (net.outBias + dot) / OUTPUT_SCALE;
+}
+
+int nnueForward(const NnueAccumulator& acc) {
+    return forward<false>(acc);
+}
+
+int nnueForwardScalar(const NnueAccumulator& acc) {
+    return forward<true>(acc);
+}
@@ -0,0 +1,48 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "pieces.h"
+#include <cstdint>
+#include <string>
+
+// Нейросетевая оценка в стиле NNUE.
+// Архитектура: HalfKP (поле своего короля × 10 фигур без королей × 64 поля)
+// -> 2 × 128 (аккумулятор int16, обновляется инкрементально в Board)
+// -> 32 -> 32 -> 1. Первый слой хранится как int16, скрытые — int8.
+constexpr int NNUE_INPUTS = 64 * 10 * 64;
+constexpr int NNUE_HALF_DIMENSIONS = 128;
+constexpr int NNUE_HIDDEN = 32;
+
+// Аккумулятор первого слоя для двух перспектив [White, Black].
+// Перспектива становится невалидной, когда её король сходил, — тогда
+// она пересчитывается целиком при следующей оценке.
+struct NnueAccumulator {
+    alignas(32) int16_t values[2][NNUE_HALF_DIMENSIONS];
+    bool valid[2] = {false, false};
+};
+
+// Загрузка весов из файла. Вызывать до начала поиска: уже посчитанные
+// аккумуляторы досок, созданных со старой сетью, не пересчитываются.
+bool loadNnue(const std::string& path, std::string& error);
+bool isNnueLoaded();
+
+// Индекс признака HalfKP для перспективы (kingSq и sq — row * 8 + col)
+int nnueFeatureIndex(Color perspective, int kingSq, Color pieceColor, PieceType type, int sq);
+
+// Инкрементальное обновление одной перспективы аккумулятора
+void nnueAddFeature(int16_t* acc, int feature);
+void nnueSubFeature(int16_t* acc, int feature);
+// Сброс перспективы к смещениям первого слоя
+void nnueResetPerspective(int16_t* acc);
+
+// Прямой проход по готовому аккумулятору, результат в сантипешках с точки зрения белых
+int nnueForward(const NnueAccumulator& acc);
+
+// Для самопроверки (nnuecheck.h): скалярные версии, с которыми сверяются
+// SIMD-пути, набор инструкций сборки и случайная сеть в формате loadNnue
+void nnueAddFeatureScalar(int16_t* acc, int feature);
+int nnueForwardScalar(const NnueAccumulator& acc);
+const char* nnueSimdName();
+bool writeRandomNnue(const std::string& path, uint64_t seed, std::string& error);
+
+#endif
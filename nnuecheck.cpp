@@ -0,0 +1,103 @@
+#include "nnuecheck.h"
+#include "board.h"
+#include "nnue.h"
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+// Позиции perft: рокировки, взятия на проходе, превращения, шахи
+static const char* const CHECK_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+};
+
+// Эталон: смещения и все признаки без SIMD
+static void rebuildScalar(const Board& board, NnueAccumulator& acc) {
+    for (int p = 0; p < 2; ++p) {
+        Color perspective = static_cast<Color>(p);
+        Square king = board.findKing(perspective);
+        nnueResetPerspective(acc.values[p]);
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 8; ++c) {
+                const Piece* piece = board.getPiece(Square{r, c});
+                if (!piece || piece->type == PieceType::King) continue;
+                nnueAddFeatureScalar(acc.values[p],
+                                     nnueFeatureIndex(perspective, king.row * 8 + king.col,
+                                                      piece->color, piece->type, r * 8 + c));
+            }
+        }
+        acc.valid[p] = true;
+    }
+}
+
+static std::string describePath(const char* fen, const std::vector<Move>& path) {
+    std::string text = fen;
+    if (!path.empty()) text += ", ходы";
+    for (const auto& move : path) text += " " + move.toString();
+    return text;
+}
+
+static bool checkPosition(const Board& board, std::string& error) {
+    const NnueAccumulator& acc = board.getNnueAccumulator();
+    NnueAccumulator expected;
+    rebuildScalar(board, expected);
+    for (int p = 0; p < 2; ++p) {
+        if (std::memcmp(acc.values[p], expected.values[p], sizeof(acc.values[p])) != 0) {
+            error = std::string("аккумулятор перспективы ") + (p == 0 ? "белых" : "чёрных") +
+                    " не совпадает с пересчётом";
+            return false;
+        }
+    }
+    int simd = nnueForward(acc);
+    int scalar = nnueForwardScalar(acc);
+    if (simd != scalar) {
+        error = "прямой проход " + std::to_string(simd) + ", скалярный " + std::to_string(scalar);
+        return false;
+    }
+    return true;
+}
+
+// Аккумулятор родителя к этому моменту посчитан, поэтому потомки получают его
+// копией и дальше обновляются по ходам, а не пересчитываются
+static bool walk(const Board& board, Color side, int depth, const char* fen, std::vector<Move>& path,
+                 NnueCheckResult& result, std::string& error) {
+    if (!checkPosition(board, error)) {
+        error = describePath(fen, path) + ": " + error;
+        return false;
+    }
+    result.positions++;
+    if (depth == 0) return true;
+
+    for (const auto& move : board.getLegalMoves(side)) {
+        Board next = board.copyForTest();
+        next.makeMove(move);
+        path.push_back(move);
+        if (!walk(next, oppositeColor(side), depth - 1, fen, path, result, error)) return false;
+        path.pop_back();
+    }
+    return true;
+}
+
+bool checkNnue(int depth, uint64_t seed, NnueCheckResult& result, std::string& error) {
+    result = NnueCheckResult{};
+    std::error_code ec;
+    std::filesystem::path netPath = std::filesystem::temp_directory_path(ec);
+    if (ec) netPath = ".";
+    netPath /= "chess-nnue-check-" + std::to_string(seed) + ".cvnn";
+
+    bool loaded = writeRandomNnue(netPath.string(), seed, error) && loadNnue(netPath.string(), error);
+    std::filesystem::remove(netPath, ec);
+    if (!loaded) return false;
+
+    for (const char* fen : CHECK_FENS) {
+        Board board;
+        Color side;
+        if (!board.loadFen(fen, side, error)) return false;
+        std::vector<Move> path;
+        if (!walk(board, side, depth, fen, path, result, error)) return false;
+    }
+    return true;
+}
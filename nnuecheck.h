@@ -0,0 +1,23 @@
+#ifndef NNUECHECK_H
+#define NNUECHECK_H
+
+#include <cstdint>
+#include <string>
+
+// Самопроверка NNUE на случайной сети нужных размеров: сеть записывается во
+// временный файл и читается обычным loadNnue. Затем из эталонных позиций perft
+// перебираются все последовательности ходов заданной глубины, и в каждой позиции:
+//  - аккумулятор доски (инкрементальные обновления при ходах и ленивый пересчёт
+//    перспективы после хода короля) совпадает со скалярным пересчётом с нуля;
+//  - прямой проход SIMD совпадает со скалярным. В сборке без ARCH SIMD-путей
+//    нет, и вторая часть сверяет скалярный проход сам с собой.
+
+struct NnueCheckResult {
+    uint64_t positions = 0; // проверено позиций
+};
+
+// Загружает случайную сеть вместо текущей. false и описание первого
+// расхождения в error.
+bool checkNnue(int depth, uint64_t seed, NnueCheckResult& result, std::string& error);
+
+#endif
@@ -0,0 +1,102 @@
+#include "pawns.h"
+#include "evalparams.h"
+#include <algorithm>
+
+PawnTerms countPawnTerms(const Board& board) {
+    // Пешки по вертикалям: битовая маска занятых горизонталей
+    uint8_t pawns[2][8] = {};
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            const Piece* piece = board.getPiece({row, col});
+            if (piece && piece->type == PieceType::Pawn) {
+                pawns[static_cast<int>(piece->color)][col] |= static_cast<uint8_t>(1u << row);
+            }
+        }
+    }
+
+    PawnTerms terms;
+    for (int c = 0; c < 2; ++c) {
+        Color color = static_cast<Color>(c);
+        int them = 1 - c;
+
+        for (int col = 0; col < 8; ++col) {
+            uint8_t mask = pawns[c][col];
+            if (!mask) continue;
+
+            int count = __builtin_popcount(mask);
+            terms.doubled[c] += count - 1;
+
+            uint8_t neighbours = (col > 0 ? pawns[c][col - 1] : 0) |
+                                 (col < 7 ? pawns[c][col + 1] : 0);
+            if (!neighbours) terms.isolated[c] += count;
+
+            // Проходная: перед пешкой нет чужих пешек на своей и соседних вертикалях
+            uint8_t enemy = pawns[them][col] |
+                            (col > 0 ? pawns[them][col - 1] : 0) |
+                            (col < 7 ? pawns[them][col + 1] : 0);
+            for (int row = 0; row < 8; ++row) {
+                if (!(mask & (1u << row))) continue;
+                uint8_t ahead = (color == Color::White)
+                    ? static_cast<uint8_t>(0xFFu << (row + 1))
+                    : static_cast<uint8_t>((1u << row) - 1);
+                // Проверяем только передовую пешку на вертикали
+                uint8_t ownAhead = mask & ahead;
+                if (ownAhead || (enemy & ahead)) continue;
+                int relRow = (color == Color::White) ? row : 7 - row;
+                terms.passed[c][relRow]++;
+                terms.passedFiles[c] |= static_cast<uint8_t>(1u << col);
+            }
+        }
+    }
+    return terms;
+}
+
+static Score toScore(EvalWeight w) {
+    return makeScore(w.mg, w.eg);
+}
+
+PawnEntry evaluatePawnStructure(const Board& board) {
+    const EvalParams& params = currentEvalParams();
+    PawnTerms terms = countPawnTerms(board);
+
+    PawnEntry entry;
+    entry.key = board.getPawnHash();
+    for (int c = 0; c < 2; ++c) {
+        int sign = (c == 0) ? 1 : -1;
+        Score score = -toScore(params.doubledPawn) * terms.doubled[c]
+                      - toScore(params.isolatedPawn) * terms.isolated[c];
+        for (int r = 0; r < 8; ++r) score += toScore(params.passedPawn[r]) * terms.passed[c][r];
+        entry.score += sign * score;
+        entry.passedFiles[c] = terms.passedFiles[c];
+    }
+    return entry;
+}
+
+PawnHashTable::PawnHashTable(int sizeLog2)
+    : entries_(size_t(1) << sizeLog2)
+    , mask_((uint64_t(1) << sizeLog2) - 1) {}
+
+const PawnEntry& PawnHashTable::probe(const Board& board) {
+    // Параметры оценки сменились — все записи устарели
+    if (generation_ != evalParamsGeneration()) {
+        clear();
+        generation_ = evalParamsGeneration();
+    }
+
+    uint64_t key = board.getPawnHash();
+    PawnEntry& entry = entries_[key & mask_];
+    ++probes_;
+    // Пустая таблица содержит ключ 0 со счётом 0 — это верно и для позиции без пешек
+    if (entry.key == key) {
+        ++hits_;
+        return entry;
+    }
+    entry = evaluatePawnStructure(board);
+    return entry;
+}
+
+void PawnHashTable::clear() {
+    std::fill(entries_.begin(), entries_.end(), PawnEntry{});
+    probes_ = 0;
+    hits_ = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include "board.h"
+#include "score.h"
+#include <cstdint>
+#include <vector>
+
+// Результат оценки пешечной структуры (с точки зрения белых)
+struct PawnEntry {
+    uint64_t key = 0;
+    Score score = 0;
+    uint8_t passedFiles[2] = {0, 0}; // битовая маска вертикалей с проходными [White, Black]
+};
+
+// Признаки пешечной структуры по цветам [White, Black]
+struct PawnTerms {
+    int doubled[2] = {0, 0};     // лишние пешки на вертикалях
+    int isolated[2] = {0, 0};
+    int passed[2][8] = {};       // проходные по горизонтали от своего края
+    uint8_t passedFiles[2] = {0, 0};
+};
+
+PawnTerms countPawnTerms(const Board& board);
+
+// Оценка пешечной структуры: сдвоенные, изолированные и проходные пешки
+PawnEntry evaluatePawnStructure(const Board& board);
+
+// Пешечная хеш-таблица: ключ — хеш только пешек (Board::getPawnHash),
+// поэтому структура пересчитывается лишь для новых пешечных конфигураций
+class PawnHashTable {
+public:
+    // sizeLog2 — логарифм числа записей (таблица прямого отображения)
+    explicit PawnHashTable(int sizeLog2 = 14);
+
+    const PawnEntry& probe(const Board& board);
+
+    uint64_t probes() const { return probes_; }
+    uint64_t hits() const { return hits_; }
+    void clear();
+
+private:
+    std::vector<PawnEntry> entries_;
+    uint64_t mask_;
+    uint64_t probes_ = 0;
+    uint64_t hits_ = 0;
+    uint32_t generation_ = 0; // поколение параметров оценки, по которым посчитаны записи
+};
+
+#endif
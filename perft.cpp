@@ -0,0 +1,91 @@
+#include "perft.h"
+
+PerftTable::PerftTable(size_t sizeMb) {
+    // Размер — наибольшая степень двойки, помещающаяся в sizeMb
+    size_t count = 1;
+    while (count * 2 * sizeof(Entry) <= sizeMb * 1024 * 1024) count *= 2;
+    entries_ = std::make_unique<Entry[]>(count);
+    mask_ = count - 1;
+}
+
+std::optional<uint64_t> PerftTable::probe(uint64_t hash, int depth) const {
+    const Entry& e = entries_[hash & mask_];
+    uint64_t data = e.data.load(std::memory_order_relaxed);
+    uint64_t key = e.key.load(std::memory_order_relaxed);
+    if ((key ^ data) != hash || static_cast<int>(data & 0xFF) != depth) return std::nullopt;
+    return data >> 8;
+}
+
+void PerftTable::store(uint64_t hash, int depth, uint64_t nodes) {
+    Entry& e = entries_[hash & mask_];
+    uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth);
+    e.key.store(hash ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t perft(const Board& board, Color side, int depth, PerftTable* table) {
+    if (depth == 0) return 1;
+
+    std::vector<Move> moves = board.getLegalMoves(side);
+    // На последнем полуходе листья — это сами легальные ходы
+    if (depth == 1) return moves.size();
+
+    uint64_t hash = 0;
+    if (table) {
+        hash = board.getHash(side);
+        if (auto cached = table->probe(hash, depth)) return *cached;
+    }
+
+    uint64_t nodes = 0;
+    for (const auto& move : moves) {
+        Board copy = board.copyForTest();
+        copy.makeMove(move);
+        nodes += perft(copy, oppositeColor(side), depth - 1, table);
+    }
+
+    if (table) table->store(hash, depth, nodes);
+    return nodes;
+}
+
+PerftResult parallelPerft(const Board& board, Color side, int depth,
+                          ThreadPool& pool, PerftTable* table) {
+    PerftResult result;
+    if (depth <= 0) {
+        result.nodes = 1;
+        return result;
+    }
+
+    std::vector<Move> moves = board.getLegalMoves(side);
+    std::vector<std::atomic<uint64_t>> counts(moves.size());
+    for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+
+    // Задача — поддерево после корневого хода и ответа: корневых ходов всего
+    // несколько десятков и они сильно различаются по размеру, а задач второго
+    // уровня сотни — перехват между потоками выравнивает нагрузку
+    for (size_t i = 0; i < moves.size(); ++i) {
+        Board afterRoot = board.copyForTest();
+        afterRoot.makeMove(moves[i]);
+        Color them = oppositeColor(side);
+
+        if (depth <= 2) {
+            counts[i] = perft(afterRoot, them, depth - 1, table);
+            continue;
+        }
+
+        for (const auto& reply : afterRoot.getLegalMoves(them)) {
+            auto position = std::make_shared<Board>(afterRoot.copyForTest());
+            position->makeMove(reply);
+            pool.submit([position, side, depth, table, &count = counts[i]]() {
+                count.fetch_add(perft(*position, side, depth - 2, table), std::memory_order_relaxed);
+            });
+        }
+    }
+    pool.waitIdle();
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        uint64_t nodes = counts[i].load();
+        result.divide.emplace_back(moves[i], nodes);
+        result.nodes += nodes;
+    }
+    return result;
+}
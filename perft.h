@@ -0,0 +1,49 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "board.h"
+#include "move.h"
+#include "threadpool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Perft — подсчёт листьев дерева легальных ходов заданной глубины.
+// Используется для проверки генератора ходов на эталонных позициях.
+
+// Общая таблица (хеш позиции, глубина) -> число узлов.
+// Без блокировок: ключ хранится в виде hash ^ data, поэтому запись,
+// разорванная параллельной записью другого потока, просто не совпадёт.
+class PerftTable {
+public:
+    explicit PerftTable(size_t sizeMb);
+
+    std::optional<uint64_t> probe(uint64_t hash, int depth) const;
+    void store(uint64_t hash, int depth, uint64_t nodes);
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> data{0}; // nodes << 8 | depth
+    };
+
+    std::unique_ptr<Entry[]> entries_;
+    size_t mask_ = 0;
+};
+
+// Однопоточный perft; table — необязательный кэш поддеревьев
+uint64_t perft(const Board& board, Color side, int depth, PerftTable* table = nullptr);
+
+struct PerftResult {
+    uint64_t nodes = 0;
+    std::vector<std::pair<Move, uint64_t>> divide; // узлы по каждому корневому ходу
+};
+
+// Параллельный perft: поддеревья после первых двух полуходов раздаются пулу
+PerftResult parallelPerft(const Board& board, Color side, int depth,
+                          ThreadPool& pool, PerftTable* table = nullptr);
+
+#endif
@@ -1,5 +1,86 @@
 #include "pieces.h"
 #include "board.h"
+#include <mutex>
+#include <new>
+
+// ===== Пул фигур =====
+// У каждого потока список свободных блоков одного размера. Память берётся у
+// системы пачками и не возвращается: фигура, созданная в одном потоке, может
+// быть удалена в другом — блок просто попадает в список удалившего потока.
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+constexpr size_t PIECE_BLOCK_SIZE = 32;
+constexpr size_t PIECE_CHUNK_BLOCKS = 1024;
+
+// Свободные блоки завершившихся потоков; их забирают потоки, которым не хватило своих
+std::mutex orphanMutex;
+FreeBlock* orphanBlocks = nullptr;
+
+struct PiecePool {
+    FreeBlock* free = nullptr;
+    PieceAllocStats stats;
+
+    ~PiecePool() {
+        if (!free) return;
+        FreeBlock* tail = free;
+        while (tail->next) tail = tail->next;
+        std::lock_guard<std::mutex> lock(orphanMutex);
+        tail->next = orphanBlocks;
+        orphanBlocks = free;
+        free = nullptr; // список теперь принадлежит сиротам
+    }
+
+    void refill() {
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            if (orphanBlocks) {
+                free = orphanBlocks;
+                orphanBlocks = nullptr;
+                return;
+            }
+        }
+        auto* chunk = static_cast<unsigned char*>(::operator new(PIECE_BLOCK_SIZE * PIECE_CHUNK_BLOCKS));
+        stats.poolRefills++;
+        for (size_t i = PIECE_CHUNK_BLOCKS; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * PIECE_BLOCK_SIZE);
+            block->next = free;
+            free = block;
+        }
+    }
+};
+
+thread_local PiecePool piecePool;
+
+} // namespace
+
+static_assert(sizeof(Piece) <= PIECE_BLOCK_SIZE, "фигура не помещается в блок пула");
+
+void* Piece::operator new(size_t size) {
+    if (size > PIECE_BLOCK_SIZE) throw std::bad_alloc();
+    PiecePool& pool = piecePool;
+    if (!pool.free) pool.refill();
+    FreeBlock* block = pool.free;
+    pool.free = block->next;
+    pool.stats.allocations++;
+    return block;
+}
+
+void Piece::operator delete(void* ptr) {
+    if (!ptr) return;
+    PiecePool& pool = piecePool;
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = pool.free;
+    pool.free = block;
+}
+
+PieceAllocStats pieceAllocStats() {
+    return piecePool.stats;
+}
 
 char Piece::fenChar() const {
     char c = '?';
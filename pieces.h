@@ -2,6 +2,8 @@
 #define PIECES_H
 
 #include "move.h"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
@@ -15,6 +17,14 @@ inline Color oppositeColor(Color c) {
 
 class Board; // forward declaration
 
+// Счётчики пула фигур текущего потока (с начала работы потока)
+struct PieceAllocStats {
+    uint64_t allocations = 0;       // фигур выделено
+    uint64_t poolRefills = 0;       // пополнений пула пачкой блоков (вызовов operator new)
+};
+
+PieceAllocStats pieceAllocStats();
+
 // Базовый класс фигуры
 class Piece {
 public:
@@ -25,6 +35,11 @@ public:
     Piece(Color c, PieceType t) : color(c), type(t) {}
     virtual ~Piece() = default;
 
+    // Фигуры живут в пуле своего потока: копия доски в поиске — это десятки
+    // фигур на каждом ходу, и без пула каждая шла бы в общий malloc
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
     virtual std::string getSymbol() const = 0;
     virtual std::vector<Move> generatePseudoLegalMoves(const Square& pos, const Board& board) const = 0;
     virtual std::unique_ptr<Piece> clone() const = 0;
@@ -0,0 +1,113 @@
+#include "profile.h"
+
+#ifdef CHESS_PROFILE
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const int POINT_COUNT = static_cast<int>(ProfilePoint::Count);
+
+static const char* const POINT_NAMES[POINT_COUNT] = {
+    "getLegalMoves", "isMoveLegal", "copyForTest", "makeMove", "evaluateBoard", "isSquareAttackedBy",
+};
+
+// Счётчики одного потока. Пишет только свой поток, поэтому атомики нужны
+// лишь для чтения при выводе; обычные load + store без блокировки шины.
+struct ThreadProfile {
+    int thread = 0;
+    std::atomic<uint64_t> calls[POINT_COUNT] = {};
+    std::atomic<uint64_t> cycles[POINT_COUNT] = {};
+};
+
+// Счётчики не освобождаются: итог нужен и после завершения потоков
+static std::mutex registryMutex;
+static std::vector<ThreadProfile*> registry;
+
+static ThreadProfile* registerThread() {
+    auto* profile = new ThreadProfile;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    profile->thread = static_cast<int>(registry.size());
+    registry.push_back(profile);
+    return profile;
+}
+
+uint64_t profileClock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void profileRecord(ProfilePoint point, uint64_t cycles) {
+    thread_local ThreadProfile* profile = registerThread();
+    int i = static_cast<int>(point);
+    profile->calls[i].store(profile->calls[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    profile->cycles[i].store(profile->cycles[i].load(std::memory_order_relaxed) + cycles,
+                             std::memory_order_relaxed);
+}
+
+struct ProfileRow {
+    std::string name;
+    uint64_t calls[POINT_COUNT] = {};
+    uint64_t cycles[POINT_COUNT] = {};
+};
+
+void dumpProfile(std::ostream& out, bool json) {
+    std::vector<ProfileRow> rows;
+    ProfileRow total;
+    total.name = "total";
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const ThreadProfile* profile : registry) {
+            ProfileRow row;
+            row.name = "thread " + std::to_string(profile->thread);
+            bool used = false;
+            for (int i = 0; i < POINT_COUNT; ++i) {
+                row.calls[i] = profile->calls[i].load(std::memory_order_relaxed);
+                row.cycles[i] = profile->cycles[i].load(std::memory_order_relaxed);
+                total.calls[i] += row.calls[i];
+                total.cycles[i] += row.cycles[i];
+                used = used || row.calls[i];
+            }
+            if (used) rows.push_back(row);
+        }
+    }
+    rows.push_back(total);
+
+    if (json) {
+        out << "{\"profile\": [";
+        for (size_t r = 0; r < rows.size(); ++r) {
+            out << (r ? ", " : "") << "{\"name\": \"" << rows[r].name << "\"";
+            for (int i = 0; i < POINT_COUNT; ++i) {
+                out << ", \"" << POINT_NAMES[i] << "\": {\"calls\": " << rows[r].calls[i]
+                    << ", \"cycles\": " << rows[r].cycles[i] << "}";
+            }
+            out << "}";
+        }
+        out << "]}\n";
+        return;
+    }
+
+    for (const auto& row : rows) {
+        out << "\n" << row.name << ":\n";
+        // Заголовок выровнен вручную: setw считает байты, а не буквы UTF-8
+        out << "функция" << std::string(13, ' ') << std::string(7, ' ') << "вызовов"
+            << std::string(12, ' ') << "тактов" << std::string(2, ' ') << "тактов/выз\n";
+        for (int i = 0; i < POINT_COUNT; ++i) {
+            uint64_t perCall = row.calls[i] ? row.cycles[i] / row.calls[i] : 0;
+            out << std::left << std::setw(20) << POINT_NAMES[i] << std::right << std::setw(14)
+                << row.calls[i] << std::setw(18) << row.cycles[i] << std::setw(12) << perCall << "\n";
+        }
+    }
+}
+#else
+void dumpProfile(std::ostream&, bool) {}
+#endif
@@ -0,0 +1,51 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdint>
+#include <ostream>
+
+// Счётчики горячих функций: число вызовов и такты (rdtsc на x86, иначе
+// наносекунды steady_clock). Включаются при сборке: make PROFILE=1
+// (определяет CHESS_PROFILE); без него PROFILE_SCOPE пуст и ничего не стоит.
+// Такты включают вложенные вызовы: getLegalMoves содержит isMoveLegal и т. д.
+
+enum class ProfilePoint {
+    GetLegalMoves,
+    IsMoveLegal,
+    CopyForTest,
+    MakeMove,
+    EvaluateBoard,
+    IsSquareAttackedBy,
+    Count
+};
+
+#ifdef CHESS_PROFILE
+constexpr bool PROFILE_ENABLED = true;
+
+uint64_t profileClock();
+void profileRecord(ProfilePoint point, uint64_t cycles);
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePoint point) : point_(point), start_(profileClock()) {}
+    ~ProfileScope() { profileRecord(point_, profileClock() - start_); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePoint point_;
+    uint64_t start_;
+};
+
+#define PROFILE_SCOPE(point) ProfileScope profileScope_(ProfilePoint::point)
+#else
+constexpr bool PROFILE_ENABLED = false;
+
+#define PROFILE_SCOPE(point) ((void)0)
+#endif
+
+// Счётчики всех потоков (строка на поток и итог) таблицей или JSON.
+// Читать, когда потоки не считают, — обычно при выходе.
+void dumpProfile(std::ostream& out, bool json);
+
+#endif
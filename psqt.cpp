@@ -0,0 +1,216 @@
+#include "psqt.h"
+#include <atomic>
+
+// --- Piece-Square Tables (с точки зрения белых, row 0 = rank 1) ---
+// Для каждой фигуры две таблицы: миттельшпиль (MG) и эндшпиль (EG)
+
+static constexpr int PAWN_MG[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  5, 10, 10,-20,-20, 10, 10,  5},
+    {  5, -5,-10,  0,  0,-10, -5,  5},
+    {  0,  0,  0, 20, 20,  0,  0,  0},
+    {  5,  5, 10, 25, 25, 10,  5,  5},
+    { 10, 10, 20, 30, 30, 20, 10, 10},
+    { 50, 50, 50, 50, 50, 50, 50, 50},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+static constexpr int PAWN_EG[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  5,  5,  5,  5,  5,  5,  5,  5},
+    { 10, 10, 10, 10, 10, 10, 10, 10},
+    { 20, 20, 20, 20, 20, 20, 20, 20},
+    { 35, 35, 35, 35, 35, 35, 35, 35},
+    { 60, 60, 60, 60, 60, 60, 60, 60},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+static constexpr int KNIGHT_MG[8][8] = {
+    {-50,-40,-30,-30,-30,-30,-40,-50},
+    {-40,-20,  0,  5,  5,  0,-20,-40},
+    {-30,  5, 10, 15, 15, 10,  5,-30},
+    {-30,  0, 15, 20, 20, 15,  0,-30},
+    {-30,  5, 15, 20, 20, 15,  5,-30},
+    {-30,  0, 10, 15, 15, 10,  0,-30},
+    {-40,-20,  0,  0,  0,  0,-20,-40},
+    {-50,-40,-30,-30,-30,-30,-40,-50}
+};
+
+static constexpr int KNIGHT_EG[8][8] = {
+    {-50,-40,-30,-30,-30,-30,-40,-50},
+    {-40,-20,  0,  0,  0,  0,-20,-40},
+    {-30,  0, 10, 15, 15, 10,  0,-30},
+    {-30,  5, 15, 20, 20, 15,  5,-30},
+    {-30,  5, 15, 20, 20, 15,  5,-30},
+    {-30,  0, 10, 15, 15, 10,  0,-30},
+    {-40,-20,  0,  0,  0,  0,-20,-40},
+    {-50,-40,-30,-30,-30,-30,-40,-50}
+};
+
+static constexpr int BISHOP_MG[8][8] = {
+    {-20,-10,-10,-10,-10,-10,-10,-20},
+    {-10,  5,  0,  0,  0,  0,  5,-10},
+    {-10, 10, 10, 10, 10, 10, 10,-10},
+    {-10,  0, 10, 10, 10, 10,  0,-10},
+    {-10,  5,  5, 10, 10,  5,  5,-10},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-20,-10,-10,-10,-10,-10,-10,-20}
+};
+
+static constexpr int BISHOP_EG[8][8] = {
+    {-20,-10,-10,-10,-10,-10,-10,-20},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    {-10,  5, 10, 15, 15, 10,  5,-10},
+    {-10,  5, 10, 15, 15, 10,  5,-10},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-20,-10,-10,-10,-10,-10,-10,-20}
+};
+
+static constexpr int ROOK_MG[8][8] = {
+    {  0,  0,  0,  5,  5,  0,  0,  0},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    {  5, 10, 10, 10, 10, 10, 10,  5},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+static constexpr int ROOK_EG[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    { 10, 10, 10, 10, 10, 10, 10, 10},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+static constexpr int QUEEN_MG[8][8] = {
+    {-20,-10,-10, -5, -5,-10,-10,-20},
+    {-10,  0,  5,  0,  0,  0,  0,-10},
+    {-10,  5,  5,  5,  5,  5,  0,-10},
+    {  0,  0,  5,  5,  5,  5,  0, -5},
+    { -5,  0,  5,  5,  5,  5,  0, -5},
+    {-10,  0,  5,  5,  5,  5,  0,-10},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-20,-10,-10, -5, -5,-10,-10,-20}
+};
+
+static constexpr int QUEEN_EG[8][8] = {
+    {-20,-10,-10, -5, -5,-10,-10,-20},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    { -5,  0, 10, 15, 15, 10,  0, -5},
+    { -5,  0, 10, 15, 15, 10,  0, -5},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-20,-10,-10, -5, -5,-10,-10,-20}
+};
+
+// Король в миттельшпиле прячется за пешками, в эндшпиле идёт в центр
+static constexpr int KING_MG[8][8] = {
+    { 20, 30, 10,  0,  0, 10, 30, 20},
+    { 20, 20,  0,  0,  0,  0, 20, 20},
+    {-10,-20,-20,-20,-20,-20,-20,-10},
+    {-20,-30,-30,-40,-40,-30,-30,-20},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30}
+};
+
+static constexpr int KING_EG[8][8] = {
+    {-50,-30,-30,-30,-30,-30,-30,-50},
+    {-30,-30,  0,  0,  0,  0,-30,-30},
+    {-30,-10, 20, 30, 30, 20,-10,-30},
+    {-30,-10, 30, 40, 40, 30,-10,-30},
+    {-30,-10, 30, 40, 40, 30,-10,-30},
+    {-30,-10, 20, 30, 30, 20,-10,-30},
+    {-30,-20,-10,  0,  0,-10,-20,-30},
+    {-50,-40,-30,-20,-20,-30,-40,-50}
+};
+
+// Материал (mg, eg) в порядке PieceType: Pawn, Rook, Knight, Bishop, Queen, King.
+// Король не оценивается материально — оба короля всегда на доске.
+static constexpr int MATERIAL_MG[6] = {100, 500, 320, 330, 900, 0};
+static constexpr int MATERIAL_EG[6] = {120, 530, 300, 320, 950, 0};
+static constexpr int PHASE[6] = {0, 2, 1, 1, 4, 0};
+
+// Пешечная структура (mg, eg); в эндшпиле проходные ценятся вдвое выше
+static constexpr EvalWeight DOUBLED_PAWN_PENALTY = {10, 20};
+static constexpr EvalWeight ISOLATED_PAWN_PENALTY = {15, 10};
+static constexpr EvalWeight PASSED_PAWN_BONUS[8] = {
+    {0, 0}, {5, 10}, {10, 20}, {20, 40}, {35, 70}, {60, 120}, {100, 200}, {0, 0}
+};
+
+using SquareTable = int[8][8];
+
+static constexpr const SquareTable* TABLES_MG[6] = {
+    &PAWN_MG, &ROOK_MG, &KNIGHT_MG, &BISHOP_MG, &QUEEN_MG, &KING_MG
+};
+static constexpr const SquareTable* TABLES_EG[6] = {
+    &PAWN_EG, &ROOK_EG, &KNIGHT_EG, &BISHOP_EG, &QUEEN_EG, &KING_EG
+};
+
+static constexpr EvalParams buildDefaultParams() {
+    EvalParams params{};
+    for (int t = 0; t < 6; ++t) {
+        params.material[t] = {MATERIAL_MG[t], MATERIAL_EG[t]};
+        for (int sq = 0; sq < 64; ++sq) {
+            params.psqt[t][sq] = {(*TABLES_MG[t])[sq / 8][sq % 8], (*TABLES_EG[t])[sq / 8][sq % 8]};
+        }
+    }
+    params.doubledPawn = DOUBLED_PAWN_PENALTY;
+    params.isolatedPawn = ISOLATED_PAWN_PENALTY;
+    for (int r = 0; r < 8; ++r) params.passedPawn[r] = PASSED_PAWN_BONUS[r];
+    return params;
+}
+
+static constexpr EvalParams DEFAULT_PARAMS = buildDefaultParams();
+
+const EvalParams& defaultEvalParams() {
+    return DEFAULT_PARAMS;
+}
+
+static constexpr PsqtTable buildPsqt(const EvalParams& params) {
+    PsqtTable table{};
+    for (int t = 0; t < 6; ++t) {
+        table.phase[t] = PHASE[t];
+        EvalWeight material = params.material[t];
+        for (int sq = 0; sq < 64; ++sq) {
+            // Белые: таблица как есть; чёрные: отражение по горизонтали и знак минус
+            EvalWeight white = params.psqt[t][sq];
+            EvalWeight black = params.psqt[t][sq ^ 56];
+            table.values[0][t][sq] = makeScore(material.mg + white.mg, material.eg + white.eg);
+            table.values[1][t][sq] = makeScore(-material.mg - black.mg, -material.eg - black.eg);
+        }
+    }
+    return table;
+}
+
+// Статическая инициализация: таблица готова до конструкторов глобальных досок
+PsqtTable PSQT = buildPsqt(DEFAULT_PARAMS);
+
+static EvalParams currentParams = DEFAULT_PARAMS;
+static std::atomic<uint32_t> paramsGeneration{0};
+
+const EvalParams& currentEvalParams() {
+    return currentParams;
+}
+
+void setEvalParams(const EvalParams& params) {
+    currentParams = params;
+    PSQT = buildPsqt(params);
+    paramsGeneration.fetch_add(1, std::memory_order_release);
+}
+
+uint32_t evalParamsGeneration() {
+    return paramsGeneration.load(std::memory_order_acquire);
+}
@@ -0,0 +1,26 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "evalparams.h"
+#include "pieces.h"
+#include "score.h"
+
+// Материал + piece-square бонус для каждой [цвет][фигура][row * 8 + col].
+// Значения уже со знаком (чёрные отрицательные) и с отражённой для чёрных
+// доской, поэтому Board прибавляет их без ветвлений.
+struct PsqtTable {
+    Score values[2][6][64];
+    int phase[6]; // вклад фигуры в фазу игры
+};
+
+extern PsqtTable PSQT; // по currentEvalParams()
+
+inline Score psqtValue(Color c, PieceType t, int row, int col) {
+    return PSQT.values[static_cast<int>(c)][static_cast<int>(t)][row * 8 + col];
+}
+
+inline int phaseValue(PieceType t) {
+    return PSQT.phase[static_cast<int>(t)];
+}
+
+#endif
@@ -0,0 +1,294 @@
+#include "record.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --- Позиции ---
+
+bool packPosition(const BoardSetup& setup, PackedPosition& packed) {
+    std::memset(&packed, 0, sizeof(packed));
+    int n = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        int code = setup.squares[sq];
+        if (code < 0) continue;
+        if (n == 32) return false;
+        packed.occupied |= 1ULL << sq;
+        packed.pieces[n / 2] |= static_cast<uint8_t>(code << ((n & 1) * 4));
+        n++;
+    }
+    packed.flags = setup.sideToMove == Color::Black ? 1 : 0;
+    for (int i = 0; i < 4; ++i) {
+        if (setup.castling[i]) packed.flags |= static_cast<uint8_t>(2 << i);
+    }
+    packed.enPassant = static_cast<uint8_t>(setup.enPassant + 1);
+    packed.halfmoveClock = static_cast<uint8_t>(std::min(setup.halfmoveClock, 255));
+    return true;
+}
+
+void unpackPosition(const PackedPosition& packed, BoardSetup& setup) {
+    int n = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (packed.occupied & (1ULL << sq)) {
+            setup.squares[sq] = static_cast<int8_t>((packed.pieces[n / 2] >> ((n & 1) * 4)) & 0xF);
+            n++;
+        } else {
+            setup.squares[sq] = -1;
+        }
+    }
+    setup.sideToMove = (packed.flags & 1) ? Color::Black : Color::White;
+    for (int i = 0; i < 4; ++i) setup.castling[i] = packed.flags & (2 << i);
+    setup.enPassant = static_cast<int>(packed.enPassant) - 1;
+    setup.halfmoveClock = packed.halfmoveClock;
+}
+
+bool packPosition(const Board& board, Color sideToMove, PackedPosition& packed) {
+    return packPosition(board.toSetup(sideToMove), packed);
+}
+
+bool unpackPosition(const PackedPosition& packed, Board& board, Color& sideToMove, std::string& error) {
+    BoardSetup setup;
+    unpackPosition(packed, setup);
+    for (int code : setup.squares) {
+        if (code >= 12) {
+            error = "неверный код фигуры в записи позиции";
+            return false;
+        }
+    }
+    if (!board.setup(setup, error)) return false;
+    sideToMove = setup.sideToMove;
+    return true;
+}
+
+size_t packPositions(const BoardSetup* setups, size_t count, PackedPosition* packed) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!packPosition(setups[i], packed[i])) return i;
+    }
+    return count;
+}
+
+void unpackPositions(const PackedPosition* packed, size_t count, BoardSetup* setups) {
+    for (size_t i = 0; i < count; ++i) unpackPosition(packed[i], setups[i]);
+}
+
+// --- Партии ---
+
+static const size_t GAME_HEADER_SIZE = sizeof(PackedPosition) + 4;
+
+void appendGame(const PackedGame& game, std::vector<uint8_t>& out) {
+    size_t base = out.size();
+    out.resize(base + GAME_HEADER_SIZE + game.moves.size() * 2);
+    uint8_t* p = out.data() + base;
+    std::memcpy(p, &game.start, sizeof(PackedPosition));
+    uint16_t count = static_cast<uint16_t>(game.moves.size());
+    std::memcpy(p + sizeof(PackedPosition), &count, 2);
+    p[sizeof(PackedPosition) + 2] = static_cast<uint8_t>(game.result);
+    p[sizeof(PackedPosition) + 3] = 0;
+    std::memcpy(p + GAME_HEADER_SIZE, game.moves.data(), game.moves.size() * 2);
+}
+
+bool readGame(const uint8_t* data, size_t size, PackedGame& game, std::string& error) {
+    if (size < GAME_HEADER_SIZE) {
+        error = "запись партии короче заголовка";
+        return false;
+    }
+    std::memcpy(&game.start, data, sizeof(PackedPosition));
+    uint16_t count;
+    std::memcpy(&count, data + sizeof(PackedPosition), 2);
+    if (size != GAME_HEADER_SIZE + size_t(count) * 2) {
+        error = "размер записи партии не совпадает с числом ходов";
+        return false;
+    }
+    game.result = static_cast<int8_t>(data[sizeof(PackedPosition) + 2]);
+    game.moves.resize(count);
+    std::memcpy(game.moves.data(), data + GAME_HEADER_SIZE, size_t(count) * 2);
+    return true;
+}
+
+// --- Контейнер ---
+
+// Заголовок файла; indexOffset = 0 у записей постоянного размера
+struct RecordHeader {
+    char magic[8];
+    uint32_t kind;
+    uint32_t recordSize;
+    uint64_t count;
+    uint64_t indexOffset;
+};
+static_assert(sizeof(RecordHeader) == 32, "заголовок контейнера — 32 байта");
+
+static const char RECORD_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'R', 'E', 'C'};
+
+RecordWriter::~RecordWriter() {
+    if (file_) std::fclose(file_);
+}
+
+bool RecordWriter::open(const std::string& path, RecordKind kind, uint32_t recordSize,
+                        std::string& error) {
+    if (file_) std::fclose(file_);
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = "не удалось создать " + path;
+        return false;
+    }
+    // Большой буфер: записи мелкие, а их сотни миллионов
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    kind_ = kind;
+    recordSize_ = recordSize;
+    count_ = 0;
+    offsets_.clear();
+
+    // Заголовок-заглушка, настоящий пишет close
+    RecordHeader header{};
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        error = "ошибка записи в " + path;
+        return false;
+    }
+    position_ = sizeof(header);
+    return true;
+}
+
+bool RecordWriter::append(const void* data, size_t size) {
+    if (!file_ || (recordSize_ && size != recordSize_)) return false;
+    if (!recordSize_) offsets_.push_back(position_);
+    if (size && std::fwrite(data, size, 1, file_) != 1) return false;
+    position_ += size;
+    count_++;
+    return true;
+}
+
+bool RecordWriter::appendRecords(const void* data, size_t count) {
+    if (!file_ || !recordSize_) return false;
+    if (count && std::fwrite(data, recordSize_, count, file_) != count) return false;
+    position_ += uint64_t(count) * recordSize_;
+    count_ += count;
+    return true;
+}
+
+bool RecordWriter::close(std::string& error) {
+    if (!file_) {
+        error = "файл записей не открыт";
+        return false;
+    }
+
+    RecordHeader header{};
+    std::memcpy(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    header.kind = static_cast<uint32_t>(kind_);
+    header.recordSize = recordSize_;
+    header.count = count_;
+
+    bool ok = true;
+    if (!recordSize_) {
+        // Индекс: начало каждой записи и конец последней
+        header.indexOffset = position_;
+        offsets_.push_back(position_);
+        ok = std::fwrite(offsets_.data(), sizeof(uint64_t), offsets_.size(), file_) == offsets_.size();
+        offsets_.clear();
+    }
+    ok = ok && std::fseek(file_, 0, SEEK_SET) == 0 &&
+         std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    if (!ok) error = "ошибка записи файла записей";
+    return ok;
+}
+
+RecordFile::~RecordFile() {
+    close();
+}
+
+// Размер записи для вида; 0 — переменный (с индексом)
+static bool expectedRecordSize(uint32_t kind, uint32_t& size) {
+    switch (static_cast<RecordKind>(kind)) {
+        case RecordKind::Positions: size = sizeof(PackedPosition); return true;
+        case RecordKind::Games:     size = 0; return true;
+        case RecordKind::Samples:   size = sizeof(TrainingSample); return true;
+    }
+    return false;
+}
+
+// Всё, к чему потом обращается record(), лежит внутри файла: после этой
+// проверки записи можно читать без дальнейших проверок границ
+static bool validHeader(const RecordHeader& header, const uint8_t* data, size_t fileSize) {
+    uint32_t recordSize;
+    if (std::memcmp(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0) return false;
+    if (!expectedRecordSize(header.kind, recordSize) || header.recordSize != recordSize) return false;
+
+    size_t body = fileSize - sizeof(header);
+    if (recordSize) return body / recordSize >= header.count;
+
+    if (header.indexOffset < sizeof(header) || header.indexOffset > fileSize ||
+        header.indexOffset % 8 != 0) {
+        return false;
+    }
+    uint64_t entries = (fileSize - header.indexOffset) / sizeof(uint64_t);
+    if (header.count >= entries) return false; // нужно count + 1 смещений
+    const auto* index = reinterpret_cast<const uint64_t*>(data + header.indexOffset);
+    if (index[0] < sizeof(header)) return false;
+    for (uint64_t i = 0; i < header.count; ++i) {
+        if (index[i + 1] < index[i]) return false;
+    }
+    return index[header.count] <= header.indexOffset;
+}
+
+bool RecordFile::open(const std::string& path, std::string& error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RecordHeader)) {
+        ::close(fd);
+        error = "файл записей короче заголовка: " + path;
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // отображение остаётся валидным после закрытия дескриптора
+    if (mapped == MAP_FAILED) {
+        error = "mmap не удался для " + path;
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+    mappedSize_ = static_cast<size_t>(st.st_size);
+
+    RecordHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (!validHeader(header, data_, mappedSize_)) {
+        close();
+        error = "неверный формат файла записей: " + path;
+        return false;
+    }
+
+    kind_ = static_cast<RecordKind>(header.kind);
+    recordSize_ = header.recordSize;
+    count_ = header.count;
+    index_ = recordSize_ ? nullptr : reinterpret_cast<const uint64_t*>(data_ + header.indexOffset);
+    return true;
+}
+
+void RecordFile::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), mappedSize_);
+        data_ = nullptr;
+        mappedSize_ = 0;
+        count_ = 0;
+        index_ = nullptr;
+    }
+}
+
+const uint8_t* RecordFile::record(uint64_t i, size_t& size) const {
+    if (recordSize_) {
+        size = recordSize_;
+        return data_ + sizeof(RecordHeader) + i * recordSize_;
+    }
+    size = static_cast<size_t>(index_[i + 1] - index_[i]);
+    return data_ + index_[i];
+}
@@ -0,0 +1,120 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "board.h"
+#include "move.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Компактные бинарные записи позиций и партий и файл-контейнер для них.
+// Числа хранятся в порядке байтов машины (little-endian на x86 и ARM).
+
+// Позиция в 32 байтах: карта занятых полей и по полубайту на фигуру
+struct PackedPosition {
+    uint64_t occupied;      // занятые поля, бит row * 8 + col
+    uint8_t pieces[16];     // фигуры в порядке возрастания полей: цвет * 6 + тип, по 4 бита
+    uint8_t flags;          // бит 0 — ход чёрных, биты 1-4 — рокировки K, Q, k, q
+    uint8_t enPassant;      // поле взятия на проходе + 1, 0 — нет
+    uint8_t halfmoveClock;  // больше 255 не бывает в партиях по правилам
+    uint8_t reserved[5];
+};
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition должен занимать 32 байта");
+
+// false — на доске больше 32 фигур
+bool packPosition(const BoardSetup& setup, PackedPosition& packed);
+void unpackPosition(const PackedPosition& packed, BoardSetup& setup);
+
+bool packPosition(const Board& board, Color sideToMove, PackedPosition& packed);
+bool unpackPosition(const PackedPosition& packed, Board& board, Color& sideToMove, std::string& error);
+
+// Пакетные варианты без выделения памяти; pack возвращает число упакованных
+// позиций — первая неупаковываемая прерывает пакет
+size_t packPositions(const BoardSetup* setups, size_t count, PackedPosition* packed);
+void unpackPositions(const PackedPosition* packed, size_t count, BoardSetup* setups);
+
+// Партия: начальная позиция и ходы по 16 бит (encodeMove из tt.h)
+struct PackedGame {
+    PackedPosition start;
+    std::vector<uint16_t> moves;
+    int8_t result = 0; // 1 — победа белых, 0 — ничья, -1 — победа чёрных
+};
+
+// Запись партии: [начальная позиция][uint16 число ходов][int8 результат][0][ходы]
+void appendGame(const PackedGame& game, std::vector<uint8_t>& out);
+bool readGame(const uint8_t* data, size_t size, PackedGame& game, std::string& error);
+
+// Обучающий пример: позиция, оценка поиска и итог партии (всё — с точки зрения белых)
+struct TrainingSample {
+    PackedPosition position;
+    int16_t score;   // сантипешки
+    int8_t result;   // 1 — победа белых, 0 — ничья, -1 — победа чёрных
+    uint8_t reserved[5];
+};
+static_assert(sizeof(TrainingSample) == 40, "TrainingSample должен занимать 40 байт");
+
+// Тип записей контейнера
+enum class RecordKind : uint32_t {
+    Positions = 1, // PackedPosition
+    Games = 2,     // appendGame
+    Samples = 3    // TrainingSample
+};
+
+// Контейнер: заголовок, записи подряд, индекс смещений в конце файла.
+// У записей постоянного размера индекса нет — смещение вычисляется.
+class RecordWriter {
+public:
+    RecordWriter() = default;
+    ~RecordWriter();
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    // recordSize > 0 — все записи этого размера
+    bool open(const std::string& path, RecordKind kind, uint32_t recordSize, std::string& error);
+    bool append(const void* data, size_t size);
+    // count записей постоянного размера подряд одним блоком
+    bool appendRecords(const void* data, size_t count);
+    // Дописывает индекс и заголовок; без close файл не читается
+    bool close(std::string& error);
+    uint64_t count() const { return count_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    RecordKind kind_ = RecordKind::Positions;
+    uint32_t recordSize_ = 0;
+    uint64_t count_ = 0;
+    uint64_t position_ = 0;
+    std::vector<uint64_t> offsets_;
+};
+
+// Чтение контейнера: файл отображается в память целиком
+class RecordFile {
+public:
+    RecordFile() = default;
+    ~RecordFile();
+    RecordFile(const RecordFile&) = delete;
+    RecordFile& operator=(const RecordFile&) = delete;
+
+    // Заголовок проверяется целиком: вид, размер записи для вида, индекс внутри
+    // файла и неубывающий. После успешного open каждая запись лежит в файле и
+    // имеет размер своего вида (у партий — переменный).
+    bool open(const std::string& path, std::string& error);
+    void close();
+    RecordKind kind() const { return kind_; }
+    uint64_t size() const { return count_; }
+
+    // Данные i-й записи и её размер
+    const uint8_t* record(uint64_t i, size_t& size) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t mappedSize_ = 0;
+    RecordKind kind_ = RecordKind::Positions;
+    uint32_t recordSize_ = 0;
+    uint64_t count_ = 0;
+    const uint64_t* index_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <cstdint>
+
+// Упакованная оценка: пара (миттельшпиль, эндшпиль) в одном int.
+// Младшие 16 бит — mg, старшие — eg. Сложение, вычитание и умножение
+// на целое работают покомпонентно, поэтому инкрементальное обновление
+// стоит одну операцию на фигуру вместо двух.
+using Score = int32_t;
+
+constexpr Score makeScore(int mg, int eg) {
+    return static_cast<Score>(static_cast<uint32_t>(eg) << 16) + mg;
+}
+
+constexpr int mgValue(Score s) {
+    return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(s)));
+}
+
+constexpr int egValue(Score s) {
+    return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(s + 0x8000) >> 16));
+}
+
+// Фаза игры: 24 — все лёгкие и тяжёлые фигуры на доске, 0 — голый эндшпиль
+constexpr int MAX_PHASE = 24;
+
+// Интерполяция между mg и eg по фазе
+constexpr int taper(Score s, int phase) {
+    if (phase > MAX_PHASE) phase = MAX_PHASE;
+    return (mgValue(s) * phase + egValue(s) * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+#endif
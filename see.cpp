@@ -0,0 +1,122 @@
+#include "see.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Стоимость фигур для размена; король дороже любого размена
+static const int SEE_VALUES[6] = {
+    100,   // Pawn
+    500,   // Rook
+    320,   // Knight
+    330,   // Bishop
+    900,   // Queen
+    20000  // King
+};
+
+static int seeValue(PieceType type) {
+    return SEE_VALUES[static_cast<int>(type)];
+}
+
+static PieceType promotionType(char promotion) {
+    switch (promotion) {
+        case 'r': return PieceType::Rook;
+        case 'b': return PieceType::Bishop;
+        case 'n': return PieceType::Knight;
+        default:  return PieceType::Queen;
+    }
+}
+
+static uint64_t squareBit(const Square& sq) {
+    return 1ULL << (sq.row * 8 + sq.col);
+}
+
+// Дальнобойная фигура цвета by за полем from на линии to -> from:
+// уход фигуры с from открывает ей поле to
+static bool xrayBehind(const Board& board, const Square& from, const Square& to, Color by) {
+    int dr = from.row - to.row;
+    int dc = from.col - to.col;
+    if (dr != 0 && dc != 0 && std::abs(dr) != std::abs(dc)) return false;
+    dr = (dr > 0) - (dr < 0);
+    dc = (dc > 0) - (dc < 0);
+    PieceType slider = (dr == 0 || dc == 0) ? PieceType::Rook : PieceType::Bishop;
+    for (Square s{from.row + dr, from.col + dc}; s.isValid(); s = {s.row + dr, s.col + dc}) {
+        const Piece* p = board.getPiece(s);
+        if (!p) continue;
+        return p->color == by && (p->type == slider || p->type == PieceType::Queen);
+    }
+    return false;
+}
+
+int staticExchange(const Board& board, const Move& move) {
+    const Piece* mover = board.getPiece(move.from);
+    if (!mover) return 0;
+
+    uint64_t occupied = board.occupancy() & ~squareBit(move.from);
+
+    // Первое взятие
+    int gain[32];
+    const Piece* victim = board.getPiece(move.to);
+    gain[0] = victim ? seeValue(victim->type) : 0;
+    if (mover->type == PieceType::Pawn && !victim && move.from.col != move.to.col) {
+        // Взятие на проходе: побитая пешка стоит рядом с полем хода
+        gain[0] = seeValue(PieceType::Pawn);
+        occupied &= ~squareBit(Square{move.from.row, move.to.col});
+    }
+    int onSquare = seeValue(mover->type); // стоимость фигуры, стоящей на поле
+    if (move.promotion != '\0') {
+        int promoted = seeValue(promotionType(move.promotion));
+        gain[0] += promoted - seeValue(PieceType::Pawn);
+        onSquare = promoted;
+    }
+
+    Color side = oppositeColor(mover->color);
+    // Поле не защищено (по карте атак позиции) и уход фигуры ничего не открывает —
+    // размена не будет. Взятие на проходе снимает ещё одну пешку, его считаем полностью.
+    bool enPassant = mover->type == PieceType::Pawn && !victim && move.from.col != move.to.col;
+    if (!enPassant && !(board.attackedSquares(side) & squareBit(move.to)) &&
+        !xrayBehind(board, move.from, move.to, side)) {
+        return gain[0];
+    }
+
+    int d = 0;
+    while (d + 1 < 32) {
+        uint64_t attackers = board.attackersTo(move.to, occupied);
+
+        // Самая дешёвая фигура стороны side, бьющая поле
+        int fromSq = -1;
+        PieceType fromType = PieceType::King;
+        bool opponentAttacks = false;
+        for (uint64_t bits = attackers; bits; bits &= bits - 1) {
+            int sq = __builtin_ctzll(bits);
+            const Piece* p = board.getPiece(Square{sq / 8, sq % 8});
+            if (p->color != side) {
+                opponentAttacks = true;
+                continue;
+            }
+            if (fromSq < 0 || seeValue(p->type) < seeValue(fromType)) {
+                fromSq = sq;
+                fromType = p->type;
+            }
+        }
+        if (fromSq < 0) break;
+        // Королём нельзя бить под защиту
+        if (fromType == PieceType::King && opponentAttacks) break;
+
+        ++d;
+        gain[d] = onSquare - gain[d - 1];
+        onSquare = seeValue(fromType);
+        // Пешка, бьющая на последнюю горизонталь, превращается
+        if (fromType == PieceType::Pawn && (move.to.row == 0 || move.to.row == 7)) {
+            gain[d] += seeValue(PieceType::Queen) - seeValue(PieceType::Pawn);
+            onSquare = seeValue(PieceType::Queen);
+        }
+        occupied &= ~(1ULL << fromSq);
+        side = oppositeColor(side);
+    }
+
+    // Каждая сторона может отказаться от продолжения размена
+    while (d > 0) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        --d;
+    }
+    return gain[0];
+}
@@ -0,0 +1,14 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "board.h"
+#include "move.h"
+
+// Статическая оценка размена (SEE): материальный итог серии взятий на поле
+// хода, если каждая сторона бьёт самой дешёвой фигурой и может остановиться.
+// Учитывает рентген (фигуры за снятыми), превращения и взятие на проходе;
+// связки не учитываются. Результат — в сантипешках для стороны, делающей ход;
+// для тихого хода — потеря при размене на поле, куда пошла фигура.
+int staticExchange(const Board& board, const Move& move);
+
+#endif
@@ -0,0 +1,539 @@
+#include "server.h"
+#include "evalparams.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <set>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Минимальное время поиска при делении времени между сессиями
+static const int64_t MIN_SHARE_MS = 10;
+
+static const char* gameStateName(GameState state) {
+    switch (state) {
+        case GameState::InProgress:                 return "inprogress";
+        case GameState::Checkmate:                  return "checkmate";
+        case GameState::Stalemate:                  return "stalemate";
+        case GameState::DrawBy50Moves:              return "draw50";
+        case GameState::DrawByRepetition:           return "repetition";
+        case GameState::DrawByInsufficientMaterial: return "insufficient";
+    }
+    return "";
+}
+
+EngineServer::EngineServer(const ServerConfig& config)
+    : config_(config)
+    , pool_(config.threads)
+{
+    if (config_.sharedHashMb > 0) {
+        sharedTt_ = std::make_unique<TranspositionTable>(config_.sharedHashMb);
+    }
+}
+
+EngineServer::~EngineServer() {
+    {
+        std::lock_guard<std::mutex> lock(scheduleMutex_);
+        queue_.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        for (auto& [id, session] : sessions_) {
+            std::lock_guard<std::mutex> sessionLock(session->mutex);
+            if (session->control) session->control->stop.store(true);
+        }
+    }
+    // Задачи пула обращаются к планировщику — дожидаемся их до разрушения полей
+    pool_.waitIdle();
+}
+
+std::shared_ptr<EngineServer::Session> EngineServer::findSession(const std::string& id) {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    auto it = sessions_.find(id);
+    return it == sessions_.end() ? nullptr : it->second;
+}
+
+// После каждого хода позиция записывается в историю доски (для повторений)
+static bool playMoves(Board& board, Color& side, GameState& state, std::istringstream& args,
+                      std::string& error) {
+    std::string token;
+    while (args >> token) {
+        auto move = parseMove(token);
+        if (!move || !board.isMoveLegal(*move, side)) {
+            error = "нелегальный ход " + token;
+            return false;
+        }
+        board.makeMove(*move);
+        side = oppositeColor(side);
+        state = board.evaluateGameState(side);
+    }
+    return true;
+}
+
+// Ходы делаются на копии: при ошибке в любом из них сессия не меняется
+bool EngineServer::applyMoves(Session& session, std::istringstream& args, std::string& error) {
+    Board board = session.board.copyWithHistory();
+    Color side = session.side;
+    GameState state = session.state;
+    if (!playMoves(board, side, state, args, error)) return false;
+    session.board = std::move(board);
+    session.side = side;
+    session.state = state;
+    return true;
+}
+
+// Позиция собирается на отдельной доске и заменяет позицию сессии, только если
+// FEN и все ходы верны
+bool EngineServer::setPosition(Session& session, std::istringstream& args, std::string& error) {
+    std::string kind;
+    args >> kind;
+    std::string fen;
+    std::string word;
+    if (kind == "startpos") {
+        fen = START_FEN;
+        args >> word;
+    } else if (kind == "fen") {
+        // Поля FEN до конца строки или до слова moves
+        while (args >> word && word != "moves") {
+            fen += (fen.empty() ? "" : " ") + word;
+        }
+    } else {
+        error = "ожидалось startpos или fen";
+        return false;
+    }
+
+    Board board;
+    Color side;
+    if (!board.loadFen(fen, side, error)) return false;
+    GameState state = board.evaluateGameState(side);
+
+    if (!word.empty() && !(kind == "fen" && word != "moves")) {
+        if (word != "moves") {
+            error = "ожидалось moves";
+            return false;
+        }
+        if (!playMoves(board, side, state, args, error)) return false;
+    }
+
+    session.board = std::move(board);
+    session.side = side;
+    session.state = state;
+    return true;
+}
+
+// Параметры читаются от встроенных, чтобы результат не зависел от предыдущих
+// перезагрузок. Пока держим scheduleMutex_, новые поиски не запускаются.
+bool EngineServer::reloadEvalParams(const std::string& path, std::string& error) {
+    EvalParams params = defaultEvalParams();
+    if (!loadEvalParams(path, params, error)) return false;
+
+    std::lock_guard<std::mutex> scheduleLock(scheduleMutex_);
+    if (running_ > 0 || !queue_.empty()) {
+        error = "идёт поиск";
+        return false;
+    }
+    setEvalParams(params);
+
+    // Оценки в таблицах транспозиций посчитаны старыми параметрами
+    if (sharedTt_) sharedTt_->clear();
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    for (auto& [id, session] : sessions_) {
+        std::lock_guard<std::mutex> sessionLock(session->mutex);
+        session->board.refreshEval();
+        if (session->tt) session->tt->clear();
+    }
+    return true;
+}
+
+bool EngineServer::handleLine(const std::string& line, const std::shared_ptr<ServerClient>& client) {
+    std::istringstream args(line);
+    std::string command, id;
+    args >> command;
+    if (command.empty()) return true;
+    if (command == "quit") return false;
+    if (command == "sessions") {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        client->send("sessions " + std::to_string(sessions_.size()));
+        return true;
+    }
+
+    if (command == "evalparams") {
+        std::string path, error;
+        args >> path;
+        if (path.empty()) {
+            client->send("error не указан файл параметров");
+        } else if (!reloadEvalParams(path, error)) {
+            client->send("error " + error);
+        } else {
+            client->send("evalparams ok");
+        }
+        return true;
+    }
+
+    args >> id;
+    if (id.empty()) {
+        client->send("error не указан идентификатор сессии");
+        return true;
+    }
+    auto fail = [&](const std::string& error) { client->send(id + " error " + error); };
+
+    if (command == "new") {
+        auto session = std::make_shared<Session>();
+        session->id = id;
+        session->client = client;
+        if (!sharedTt_ && config_.sessionHashMb > 0) {
+            session->tt = std::make_unique<TranspositionTable>(config_.sessionHashMb);
+        }
+        std::string rest;
+        std::getline(args, rest);
+        std::istringstream position(rest.find_first_not_of(' ') == std::string::npos ? "startpos" : rest);
+        std::string error;
+        if (!setPosition(*session, position, error)) {
+            fail(error);
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        if (!sessions_.emplace(id, session).second) {
+            fail("сессия уже существует");
+            return true;
+        }
+        client->send(id + " ok");
+        return true;
+    }
+
+    auto session = findSession(id);
+    if (!session || session->client->id != client->id) {
+        fail("нет такой сессии");
+        return true;
+    }
+
+    if (command == "close") {
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->control) session->control->stop.store(true);
+        }
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        sessions_.erase(id);
+        client->send(id + " closed");
+        return true;
+    }
+
+    if (command == "stop") {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->control) session->control->stop.store(true);
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(session->mutex);
+
+    if (command == "state") {
+        client->send(id + " state " + session->board.getPositionKey(session->side) + " " +
+                     gameStateName(session->state));
+        return true;
+    }
+
+    if (session->control) {
+        fail("идёт поиск");
+        return true;
+    }
+
+    std::string error;
+    if (command == "position") {
+        if (!setPosition(*session, args, error)) fail(error);
+        return true;
+    }
+    if (command == "move") {
+        if (!applyMoves(*session, args, error)) fail(error);
+        return true;
+    }
+    if (command == "go") {
+        SearchLimits limits = config_.defaultLimits;
+        int multiPv = 1;
+        std::string key;
+        while (args >> key) {
+            int64_t value = 0;
+            if (!(args >> value)) {
+                fail("ожидалось число после " + key);
+                return true;
+            }
+            if (key == "depth") limits.depth = static_cast<int>(value);
+            else if (key == "movetime") limits.timeMs = value;
+            else if (key == "nodes") limits.nodes = static_cast<uint64_t>(value);
+            else if (key == "multipv") multiPv = static_cast<int>(value);
+            else {
+                fail("неизвестный параметр " + key);
+                return true;
+            }
+        }
+        if (session->state != GameState::InProgress) {
+            fail(std::string("партия окончена: ") + gameStateName(session->state));
+            return true;
+        }
+
+        session->control = std::make_shared<SearchControl>();
+        lock.unlock();
+
+        std::lock_guard<std::mutex> scheduleLock(scheduleMutex_);
+        queue_.push_back({session, limits, multiPv});
+        dispatch();
+        return true;
+    }
+
+    fail("неизвестная команда " + command);
+    return true;
+}
+
+// Вызывается под scheduleMutex_. Каждый поиск получает ограничение по времени
+// не больше maxSearchMs, даже если в go задана только глубина или узлы. Если
+// желающих искать больше, чем потоков, время сокращается пропорционально —
+// все сессии получают равную долю процессорного времени, а очередь не растёт.
+void EngineServer::dispatch() {
+    while (running_ < pool_.size() && !queue_.empty()) {
+        PendingSearch job = std::move(queue_.front());
+        queue_.pop_front();
+
+        int64_t budget = config_.maxSearchMs;
+        if (job.limits.timeMs > 0) budget = std::min(budget, job.limits.timeMs);
+        size_t demand = running_ + 1 + queue_.size();
+        if (demand > pool_.size()) {
+            budget = budget * static_cast<int64_t>(pool_.size()) / static_cast<int64_t>(demand);
+        }
+        job.limits.timeMs = std::max<int64_t>(MIN_SHARE_MS, budget);
+
+        running_++;
+        pool_.submit([this, job = std::move(job)]() mutable {
+            runSearch(std::move(job));
+            std::lock_guard<std::mutex> lock(scheduleMutex_);
+            running_--;
+            dispatch();
+        });
+    }
+}
+
+void EngineServer::runSearch(PendingSearch job) {
+    Session& session = *job.session;
+    std::shared_ptr<SearchControl> control;
+    Board board;
+    Color side;
+    SearchOptions options;
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        control = session.control;
+        board = session.board.copyWithHistory();
+        side = session.side;
+        options.backend = getEvalBackend();
+        options.multiPv = job.multiPv;
+        options.tt = sharedTt_ ? sharedTt_.get() : session.tt.get();
+    }
+
+    const std::string& id = session.id;
+    ServerClient& client = *session.client;
+    SearchResult result = search(board, side, job.limits, options, control.get(),
+        [&](const SearchInfo& info) {
+            std::string line = id + " info depth " + std::to_string(info.depth) +
+                               " multipv " + std::to_string(info.multiPv) +
+                               " score " + std::to_string(info.score) +
+                               " nodes " + std::to_string(info.nodes) +
+                               " time " + std::to_string(static_cast<int64_t>(info.seconds * 1000)) +
+                               " pv";
+            for (const auto& move : info.pv) line += " " + move.toString();
+            client.send(line);
+        });
+
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        session.control.reset();
+    }
+    client.send(id + " bestmove " + result.bestMove.toString());
+}
+
+void EngineServer::closeClientSessions(int clientId) {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        if (it->second->client->id == clientId) {
+            std::lock_guard<std::mutex> sessionLock(it->second->mutex);
+            if (it->second->control) it->second->control->stop.store(true);
+            it = sessions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// --- Транспорт ---
+
+int runServerStdio(const ServerConfig& config) {
+    EngineServer server(config);
+    std::mutex outputMutex;
+    auto client = std::make_shared<ServerClient>();
+    client->send = [&outputMutex](const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << line << std::endl;
+    };
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!server.handleLine(line, client)) break;
+    }
+    server.closeClientSessions(client->id);
+    return 0;
+}
+
+// Соединения сокет-сервера: сервер разрушается, только когда все их потоки завершены
+struct ConnectionThreads {
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    std::mutex mutex;
+    std::set<int> fds; // открытые сокеты клиентов
+    std::list<Worker> workers;
+
+    // Дождаться уже отключившихся клиентов, чтобы список не рос
+    void reap() {
+        for (auto it = workers.begin(); it != workers.end();) {
+            if (it->done->load()) {
+                it->thread.join();
+                it = workers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Отключить всех клиентов и дождаться их потоков
+    void closeAll() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int fd : fds) ::shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& worker : workers) worker.thread.join();
+        workers.clear();
+    }
+};
+
+static void serveConnection(EngineServer& server, ConnectionThreads& connections, int fd, int clientId) {
+    // Поиски закрытых сессий могут дописывать ответы и после отключения —
+    // запись идёт под мьютексом и прекращается, когда сокет закрыт
+    struct Connection {
+        std::mutex mutex;
+        bool open = true;
+    };
+    auto connection = std::make_shared<Connection>();
+    auto client = std::make_shared<ServerClient>();
+    client->id = clientId;
+    client->send = [fd, connection](const std::string& line) {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        if (!connection->open) return;
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return; // клиент отключился — ответ теряется
+            sent += static_cast<size_t>(n);
+        }
+    };
+
+    std::string buffer;
+    char chunk[4096];
+    bool open = true;
+    while (open) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(n));
+        size_t pos;
+        while (open && (pos = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, pos);
+            buffer.erase(0, pos + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            open = server.handleLine(line, client);
+        }
+    }
+
+    server.closeClientSessions(clientId);
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    connection->open = false;
+    {
+        // Сначала из списка, потом close: closeAll не тронет чужой сокет с тем же номером
+        std::lock_guard<std::mutex> registryLock(connections.mutex);
+        connections.fds.erase(fd);
+    }
+    ::close(fd);
+}
+
+int runServerSocket(const ServerConfig& config, const std::string& path) {
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Ошибка: socket: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Ошибка: слишком длинный путь сокета\n";
+        ::close(listenFd);
+        return 1;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Старый сокет прошлого запуска удаляем, любой другой файл — нет
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            std::cerr << "Ошибка: " << path << " существует и не является сокетом\n";
+            ::close(listenFd);
+            return 1;
+        }
+        ::unlink(path.c_str());
+    }
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listenFd, 64) < 0) {
+        std::cerr << "Ошибка: " << path << ": " << std::strerror(errno) << "\n";
+        ::close(listenFd);
+        return 1;
+    }
+
+    EngineServer server(config);
+    std::cout << "Сервер слушает " << path << std::endl;
+
+    ConnectionThreads connections;
+
+    // Клиентов идентифицируем номером: 0 занят stdin-режимом
+    int nextClient = 1;
+    while (true) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Ошибка: accept: " << std::strerror(errno) << "\n";
+            break;
+        }
+        connections.reap();
+        {
+            std::lock_guard<std::mutex> lock(connections.mutex);
+            connections.fds.insert(fd);
+        }
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        int clientId = nextClient++;
+        std::thread thread([&server, &connections, fd, clientId, done]() {
+            serveConnection(server, connections, fd, clientId);
+            done->store(true);
+        });
+        connections.workers.push_back({std::move(thread), done});
+    }
+
+    ::close(listenFd);
+    connections.closeAll();
+    return 1;
+}
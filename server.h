@@ -0,0 +1,109 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "ai.h"
+#include "threadpool.h"
+#include "tt.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// Сервер движка: много партий (сессий) в одном процессе.
+// У каждой сессии своя доска и история, потоки поиска общие.
+//
+// Протокол построчный, ответы начинаются с идентификатора сессии:
+//   new <id> [startpos|fen <FEN>] [moves <ходы>...]
+//                                           новая сессия
+//   position <id> startpos|fen <FEN> [moves <ходы>...]
+//   move <id> <ход>...                      сделать ходы
+//   go <id> [depth N] [movetime MS] [nodes N] [multipv K]
+//                                           -> <id> info depth .. multipv .. score .. nodes .. time .. pv ..
+//                                           -> <id> bestmove <ход>
+//   stop <id>                               прервать поиск (bestmove придёт всё равно)
+//   state <id>                              -> <id> state <fen> <состояние>
+//   close <id>                              закрыть сессию
+//   sessions                                -> sessions <число>
+//   evalparams <файл>                       -> evalparams ok
+//                                           заменить параметры оценки; только когда нет поисков
+//   quit                                    завершить (в режиме сокета — отключиться)
+// Ошибка: <id> error <текст>. Идентификаторы сессий общие для всех клиентов,
+// но управлять сессией может только создавший её клиент.
+
+struct ServerConfig {
+    unsigned threads = 0;        // потоки поиска; 0 — все ядра
+    size_t sharedHashMb = 0;     // > 0 — одна таблица транспозиций на все сессии
+    size_t sessionHashMb = 1;    // иначе своя у каждой сессии (0 — без таблицы)
+    SearchLimits defaultLimits;  // для go без параметров
+    // Потолок времени любого поиска, в том числе ограниченного только глубиной
+    // или узлами: поток пула освобождается для других сессий. Когда желающих
+    // искать больше, чем потоков, потолок делится между ними.
+    int64_t maxSearchMs = 5000;
+};
+
+// Клиент сервера: ответы сессий, созданных им, уходят в его send
+struct ServerClient {
+    int id = 0;
+    std::function<void(const std::string&)> send;
+};
+
+class EngineServer {
+public:
+    explicit EngineServer(const ServerConfig& config);
+    ~EngineServer();
+
+    // Выполнить строку протокола; false — клиент прислал quit
+    bool handleLine(const std::string& line, const std::shared_ptr<ServerClient>& client);
+
+    // Закрыть все сессии клиента (при отключении)
+    void closeClientSessions(int clientId);
+
+private:
+    struct Session {
+        std::string id;
+        std::shared_ptr<ServerClient> client;
+        std::mutex mutex;
+        Board board;
+        Color side = Color::White;
+        GameState state = GameState::InProgress; // после последнего хода
+        std::unique_ptr<TranspositionTable> tt;
+        std::shared_ptr<SearchControl> control; // не null, пока поиск запрошен или идёт
+    };
+
+    struct PendingSearch {
+        std::shared_ptr<Session> session;
+        SearchLimits limits;
+        int multiPv = 1;
+    };
+
+    ServerConfig config_;
+    ThreadPool pool_;
+    std::unique_ptr<TranspositionTable> sharedTt_;
+
+    std::mutex sessionsMutex_;
+    std::map<std::string, std::shared_ptr<Session>> sessions_;
+
+    // Планировщик: поиски стоят в общей очереди FIFO и запускаются,
+    // только когда есть свободный поток
+    std::mutex scheduleMutex_;
+    std::deque<PendingSearch> queue_;
+    unsigned running_ = 0;
+
+    std::shared_ptr<Session> findSession(const std::string& id);
+    bool reloadEvalParams(const std::string& path, std::string& error);
+    bool setPosition(Session& session, std::istringstream& args, std::string& error);
+    bool applyMoves(Session& session, std::istringstream& args, std::string& error);
+    void dispatch();
+    void runSearch(PendingSearch job);
+};
+
+// Сервер на stdin/stdout
+int runServerStdio(const ServerConfig& config);
+// Сервер на локальном Unix-сокете; клиентов может быть много
+int runServerSocket(const ServerConfig& config, const std::string& path);
+
+#endif
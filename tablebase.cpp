@@ -0,0 +1,1069 @@
+#include "tablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+// Реализация следует эталонному формату Syzygy (R. de Man):
+// позиция кодируется в индекс по группам фигур, значения хранятся в блоках,
+// сжатых каноническим кодом Хаффмана поверх рекурсивного попарного сжатия.
+
+static const int TB_PIECES = 7;
+static const int MAX_DTZ = 1 << 18;
+
+// Флаги таблицы: все относятся к DTZ, кроме SINGLE_VALUE
+enum TbFlag {
+    TB_STM = 1,
+    TB_MAPPED = 2,
+    TB_WIN_PLIES = 4,
+    TB_LOSS_PLIES = 8,
+    TB_WIDE = 16,
+    TB_SINGLE_VALUE = 128
+};
+
+enum ProbeState {
+    PROBE_FAIL = 0,
+    PROBE_OK = 1,
+    PROBE_CHANGE_STM = -1,        // DTZ хранится для другой стороны хода
+    PROBE_ZEROING_BEST_MOVE = 2   // лучший ход — взятие или ход пешкой
+};
+
+// --- Вспомогательные функции полей (sq = row * 8 + col) ---
+
+static int rankOf(int sq) { return sq >> 3; }
+static int fileOf(int sq) { return sq & 7; }
+static int flipFile(int sq) { return sq ^ 7; }
+static int flipRank(int sq) { return sq ^ 56; }
+static int offA1H8(int sq) { return rankOf(sq) - fileOf(sq); }
+
+// --- Таблицы индексации ---
+
+static int MAP_PAWNS[64];
+static int MAP_B1H1H7[64];
+static int MAP_A1D1D4[64];
+static int MAP_KK[10][64];
+static uint64_t BINOMIAL[6][64];
+static int LEAD_PAWN_IDX[6][64];
+static int LEAD_PAWNS_SIZE[6][4];
+
+static void initIndexTables() {
+    // MAP_B1H1H7: поле под диагональю a1-h8 -> 0..27
+    int code = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (offA1H8(sq) < 0) MAP_B1H1H7[sq] = code++;
+    }
+
+    // MAP_A1D1D4: поле треугольника a1-d1-d4 -> 0..9, поля диагонали последними
+    std::vector<int> diagonal;
+    code = 0;
+    for (int sq = 0; sq <= 27; ++sq) {
+        if (fileOf(sq) > 3) continue;
+        if (offA1H8(sq) < 0) {
+            MAP_A1D1D4[sq] = code++;
+        } else if (offA1H8(sq) == 0) {
+            diagonal.push_back(sq);
+        }
+    }
+    for (int sq : diagonal) MAP_A1D1D4[sq] = code++;
+
+    // MAP_KK: 462 легальные расстановки двух королей, первый в треугольнике a1-d1-d4.
+    // Если первый на диагонали a1-d4, второй не выше диагонали a1-h8.
+    std::vector<std::pair<int, int>> bothOnDiagonal;
+    code = 0;
+    for (int idx = 0; idx < 10; ++idx) {
+        for (int s1 = 0; s1 <= 27; ++s1) {
+            if (fileOf(s1) > 3 || MAP_A1D1D4[s1] != idx || (idx == 0 && s1 != 1)) continue;
+            for (int s2 = 0; s2 < 64; ++s2) {
+                bool adjacent = std::abs(rankOf(s1) - rankOf(s2)) <= 1 &&
+                                std::abs(fileOf(s1) - fileOf(s2)) <= 1;
+                if (adjacent) continue; // нелегально (включая s1 == s2)
+                if (!offA1H8(s1) && offA1H8(s2) > 0) continue;
+                if (!offA1H8(s1) && !offA1H8(s2)) {
+                    bothOnDiagonal.push_back({idx, s2});
+                } else {
+                    MAP_KK[idx][s2] = code++;
+                }
+            }
+        }
+    }
+    for (auto [idx, s2] : bothOnDiagonal) MAP_KK[idx][s2] = code++;
+
+    // Биномиальные коэффициенты: BINOMIAL[k][n] способов выбрать k из n
+    BINOMIAL[0][0] = 1;
+    for (int n = 1; n < 64; ++n) {
+        for (int k = 0; k < 6 && k <= n; ++k) {
+            BINOMIAL[k][n] = (k > 0 ? BINOMIAL[k - 1][n - 1] : 0) +
+                             (k < n ? BINOMIAL[k][n - 1] : 0);
+        }
+    }
+
+    // MAP_PAWNS: поля a2-h7 -> 0..47. Ведущая пешка — с наибольшим значением:
+    // ближе к краю доски, а на одной вертикали — ниже.
+    int availableSquares = 47;
+    for (int leadPawnsCnt = 1; leadPawnsCnt <= 5; ++leadPawnsCnt) {
+        for (int f = 0; f < 4; ++f) {
+            int idx = 0;
+            for (int r = 1; r <= 6; ++r) {
+                int sq = r * 8 + f;
+                if (leadPawnsCnt == 1) {
+                    MAP_PAWNS[sq] = availableSquares--;
+                    MAP_PAWNS[flipFile(sq)] = availableSquares--;
+                }
+                LEAD_PAWN_IDX[leadPawnsCnt][sq] = idx;
+                idx += static_cast<int>(BINOMIAL[leadPawnsCnt - 1][MAP_PAWNS[sq]]);
+            }
+            LEAD_PAWNS_SIZE[leadPawnsCnt][f] = idx;
+        }
+    }
+}
+
+static bool pawnsComp(int a, int b) {
+    return MAP_PAWNS[a] < MAP_PAWNS[b];
+}
+
+// --- Чтение чисел из файла ---
+
+static uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLe32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static uint32_t readBe32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static uint64_t readBe64(const uint8_t* p) {
+    return (uint64_t(readBe32(p)) << 32) | readBe32(p + 4);
+}
+
+// --- Структуры таблиц ---
+
+// Индексная информация одной подтаблицы: (сторона хода) × (вертикаль ведущей пешки)
+struct PairsData {
+    uint8_t flags = 0;
+    uint8_t maxSymLen = 0;
+    uint8_t minSymLen = 0;              // для SINGLE_VALUE — само значение
+    uint32_t numBlocks = 0;
+    size_t blockSize = 0;
+    size_t span = 0;                    // шаг разреженного индекса
+    const uint8_t* lowestSym = nullptr; // uint16 LE: младший символ каждой длины
+    const uint8_t* btree = nullptr;     // по 3 байта: левый и правый 12-битные символы
+    const uint8_t* blockLength = nullptr; // uint16 LE: число значений в блоке минус 1
+    uint32_t blockLengthSize = 0;
+    const uint8_t* sparseIndex = nullptr; // по 6 байт: номер блока (4) и смещение (2)
+    size_t sparseIndexSize = 0;
+    const uint8_t* data = nullptr;      // сжатые блоки
+    std::vector<uint64_t> base64;       // младший код каждой длины, дополненный до 64 бит
+    std::vector<uint8_t> symlen;        // число значений в символе минус 1
+    int pieces[TB_PIECES] = {};         // порядок фигур задаёт группы
+    uint64_t groupIdx[TB_PIECES + 1] = {};
+    int groupLen[TB_PIECES + 1] = {};
+    uint16_t mapIdx[4] = {};            // для DTZ: смещения карт значений
+};
+
+struct TbTable {
+    bool isDtz = false;
+    std::string name; // например, "KRPvKR"
+
+    std::atomic<bool> ready{false};
+    void* baseAddress = nullptr;
+    size_t mappingSize = 0;
+    const uint8_t* map = nullptr; // карты значений DTZ
+
+    uint64_t key = 0;  // материал, если «сильная» сторона — белые
+    uint64_t key2 = 0; // материал с переставленными цветами
+    int pieceCount = 0;
+    bool hasPawns = false;
+    bool hasUniquePieces = false;
+    uint8_t pawnCount[2] = {0, 0}; // [ведущий цвет, другой цвет]
+    PairsData items[2][4];         // [сторона хода][вертикаль a..d или 0]
+
+    int sides() const { return isDtz ? 1 : 2; }
+    PairsData* get(int stm, int f) { return &items[stm % sides()][hasPawns ? f : 0]; }
+
+    ~TbTable() {
+        if (baseAddress) munmap(baseAddress, mappingSize);
+    }
+};
+
+struct TbEntry {
+    TbTable* wdl = nullptr;
+    TbTable* dtz = nullptr;
+};
+
+static std::vector<std::string> tbPaths;
+static std::vector<std::unique_ptr<TbTable>> tbTables;
+static std::unordered_map<uint64_t, TbEntry> tbIndex;
+static int tbMaxPieces = 0;
+static TablebaseConfig tbConfig;
+static std::mutex tbMapMutex;
+
+// --- Материал ---
+
+// Тип фигуры Syzygy: 1..6 — пешка, конь, слон, ладья, ферзь, король
+static int tbPieceType(PieceType t) {
+    switch (t) {
+        case PieceType::Pawn:   return 1;
+        case PieceType::Knight: return 2;
+        case PieceType::Bishop: return 3;
+        case PieceType::Rook:   return 4;
+        case PieceType::Queen:  return 5;
+        case PieceType::King:   return 6;
+    }
+    return 0;
+}
+
+static int tbTypeFromChar(char c) {
+    switch (c) {
+        case 'P': return 1;
+        case 'N': return 2;
+        case 'B': return 3;
+        case 'R': return 4;
+        case 'Q': return 5;
+        case 'K': return 6;
+    }
+    return 0;
+}
+
+// Ключ материала: по 4 бита на число фигур каждого типа и цвета
+static uint64_t materialKey(const int counts[2][7]) {
+    uint64_t key = 0;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 1; t <= 6; ++t) {
+            key |= uint64_t(counts[c][t]) << (4 * (c * 6 + t - 1));
+        }
+    }
+    return key;
+}
+
+// Снимок позиции для индексации: код фигуры на каждом поле
+// (1..6 белые, 9..14 чёрные, 0 — пусто)
+struct TbPosition {
+    int pieceOn[64] = {};
+    bool blackToMove = false;
+    uint64_t materialKey = 0;
+    int pieceCount = 0;
+};
+
+static TbPosition makeTbPosition(const Board& board, Color sideToMove) {
+    TbPosition pos;
+    int counts[2][7] = {};
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            const Piece* piece = board.getPiece({row, col});
+            if (!piece) continue;
+            int c = (piece->color == Color::White) ? 0 : 1;
+            int t = tbPieceType(piece->type);
+            pos.pieceOn[row * 8 + col] = t + 8 * c;
+            counts[c][t]++;
+            pos.pieceCount++;
+        }
+    }
+    pos.blackToMove = (sideToMove == Color::Black);
+    pos.materialKey = materialKey(counts);
+    return pos;
+}
+
+// --- Отображение файлов ---
+
+static std::string findTableFile(const std::string& fileName) {
+    for (const auto& dir : tbPaths) {
+        std::string path = dir + "/" + fileName;
+        if (access(path.c_str(), R_OK) == 0) return path;
+    }
+    return "";
+}
+
+static const uint8_t* mapTableFile(const std::string& path, TbTable& e) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size % 64 != 16) {
+        close(fd);
+        std::cerr << "Повреждённый файл таблицы: " << path << "\n";
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "mmap не удался: " << path << "\n";
+        return nullptr;
+    }
+    madvise(base, static_cast<size_t>(st.st_size), MADV_RANDOM);
+
+    static const uint8_t MAGIC_WDL[4] = {0x71, 0xE8, 0x23, 0x5D};
+    static const uint8_t MAGIC_DTZ[4] = {0xD7, 0x66, 0x0C, 0xA5};
+    const uint8_t* data = static_cast<const uint8_t*>(base);
+    if (std::memcmp(data, e.isDtz ? MAGIC_DTZ : MAGIC_WDL, 4) != 0) {
+        munmap(base, static_cast<size_t>(st.st_size));
+        std::cerr << "Неверная сигнатура таблицы: " << path << "\n";
+        return nullptr;
+    }
+
+    e.baseAddress = base;
+    e.mappingSize = static_cast<size_t>(st.st_size);
+    return data + 4;
+}
+
+// --- Разбор заголовка таблицы ---
+
+// Группировка фигур: фигуры одного типа и цвета кодируются вместе.
+// Ведущая группа без пешек — три уникальные фигуры (или два короля).
+static void setGroups(TbTable& e, PairsData* d, const int order[2], int f) {
+    int n = 0;
+    int firstLen = e.hasPawns ? 0 : e.hasUniquePieces ? 3 : 2;
+    d->groupLen[n] = 1;
+
+    for (int i = 1; i < e.pieceCount; ++i) {
+        if (--firstLen > 0 || d->pieces[i] == d->pieces[i - 1]) {
+            d->groupLen[n]++;
+        } else {
+            d->groupLen[++n] = 1;
+        }
+    }
+    d->groupLen[++n] = 0;
+
+    // Порядок кодирования групп задаётся таблицей: ведущая группа на позиции
+    // order[0], оставшиеся пешки (если пешки у обеих сторон) — на order[1]
+    bool pp = e.hasPawns && e.pawnCount[1];
+    int next = pp ? 2 : 1;
+    int freeSquares = 64 - d->groupLen[0] - (pp ? d->groupLen[1] : 0);
+    uint64_t idx = 1;
+
+    for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+        if (k == order[0]) {
+            d->groupIdx[0] = idx;
+            idx *= e.hasPawns ? LEAD_PAWNS_SIZE[d->groupLen[0]][f]
+                 : e.hasUniquePieces ? 31332 : 462;
+        } else if (k == order[1]) {
+            d->groupIdx[1] = idx;
+            idx *= BINOMIAL[d->groupLen[1]][48 - d->groupLen[0]];
+        } else {
+            d->groupIdx[next] = idx;
+            idx *= BINOMIAL[d->groupLen[next]][freeSquares];
+            freeSquares -= d->groupLen[next++];
+        }
+    }
+    d->groupIdx[n] = idx;
+}
+
+static int btreeLeft(const PairsData* d, int sym) {
+    const uint8_t* lr = d->btree + 3 * sym;
+    return ((lr[1] & 0xF) << 8) | lr[0];
+}
+
+static int btreeRight(const PairsData* d, int sym) {
+    const uint8_t* lr = d->btree + 3 * sym;
+    return (lr[2] << 4) | (lr[1] >> 4);
+}
+
+// Число значений, которые раскрывает символ (минус 1)
+static uint8_t setSymlen(PairsData* d, int sym, std::vector<bool>& visited) {
+    visited[sym] = true;
+    int right = btreeRight(d, sym);
+    if (right == 0xFFF) return 0; // лист
+
+    int left = btreeLeft(d, sym);
+    if (!visited[left]) d->symlen[left] = setSymlen(d, left, visited);
+    if (!visited[right]) d->symlen[right] = setSymlen(d, right, visited);
+    return static_cast<uint8_t>(d->symlen[left] + d->symlen[right] + 1);
+}
+
+static const uint8_t* setSizes(PairsData* d, const uint8_t* data) {
+    d->flags = *data++;
+
+    if (d->flags & TB_SINGLE_VALUE) {
+        d->numBlocks = 0;
+        d->span = 0;
+        d->blockLengthSize = 0;
+        d->sparseIndexSize = 0;
+        d->minSymLen = *data++;
+        return data;
+    }
+
+    // Последний элемент groupIdx — размер таблицы
+    uint64_t tbSize = d->groupIdx[std::find(d->groupLen, d->groupLen + TB_PIECES, 0) - d->groupLen];
+
+    d->blockSize = size_t(1) << *data++;
+    d->span = size_t(1) << *data++;
+    d->sparseIndexSize = static_cast<size_t>((tbSize + d->span - 1) / d->span);
+    uint8_t padding = *data++;
+    d->numBlocks = readLe32(data);
+    data += 4;
+    d->blockLengthSize = d->numBlocks + padding;
+    d->maxSymLen = *data++;
+    d->minSymLen = *data++;
+    d->lowestSym = data;
+    d->base64.resize(d->maxSymLen - d->minSymLen + 1);
+
+    // Канонический код: более длинные символы численно меньше.
+    // base64[i] — младший код длины minSymLen + i, дополненный до 64 бит.
+    for (int i = static_cast<int>(d->base64.size()) - 2; i >= 0; --i) {
+        d->base64[i] = (d->base64[i + 1] + readLe16(d->lowestSym + 2 * i) -
+                        readLe16(d->lowestSym + 2 * (i + 1))) / 2;
+    }
+    for (size_t i = 0; i < d->base64.size(); ++i) {
+        d->base64[i] <<= 64 - i - d->minSymLen;
+    }
+
+    data += d->base64.size() * 2;
+    d->symlen.resize(readLe16(data));
+    data += 2;
+    d->btree = data;
+
+    std::vector<bool> visited(d->symlen.size());
+    for (size_t sym = 0; sym < d->symlen.size(); ++sym) {
+        if (!visited[sym]) d->symlen[sym] = setSymlen(d, static_cast<int>(sym), visited);
+    }
+
+    return data + d->symlen.size() * 3 + (d->symlen.size() & 1);
+}
+
+static const uint8_t* setDtzMap(TbTable& e, const uint8_t* data, int maxFile) {
+    e.map = data;
+
+    for (int f = 0; f <= maxFile; ++f) {
+        PairsData* d = e.get(0, f);
+        if (!(d->flags & TB_MAPPED)) continue;
+        if (d->flags & TB_WIDE) {
+            data += reinterpret_cast<uintptr_t>(data) & 1; // выравнивание на слово
+            for (int i = 0; i < 4; ++i) {
+                d->mapIdx[i] = static_cast<uint16_t>((data - e.map) / 2 + 1);
+                data += 2 * readLe16(data) + 2;
+            }
+        } else {
+            for (int i = 0; i < 4; ++i) {
+                d->mapIdx[i] = static_cast<uint16_t>(data - e.map + 1);
+                data += *data + 1;
+            }
+        }
+    }
+
+    return data + (reinterpret_cast<uintptr_t>(data) & 1);
+}
+
+static void initTable(TbTable& e, const uint8_t* data) {
+    data++; // флаги файла: разделение по стороне хода и наличие пешек
+
+    int sides = (!e.isDtz && e.key != e.key2) ? 2 : 1;
+    int maxFile = e.hasPawns ? 3 : 0;
+    bool pp = e.hasPawns && e.pawnCount[1];
+
+    for (int f = 0; f <= maxFile; ++f) {
+        for (int i = 0; i < sides; ++i) *e.get(i, f) = PairsData();
+
+        int order[2][2] = {
+            {*data & 0xF, pp ? *(data + 1) & 0xF : 0xF},
+            {*data >> 4, pp ? *(data + 1) >> 4 : 0xF}
+        };
+        data += 1 + pp;
+
+        for (int k = 0; k < e.pieceCount; ++k, ++data) {
+            for (int i = 0; i < sides; ++i) {
+                e.get(i, f)->pieces[k] = i ? *data >> 4 : *data & 0xF;
+            }
+        }
+
+        for (int i = 0; i < sides; ++i) setGroups(e, e.get(i, f), order[i], f);
+    }
+
+    data += reinterpret_cast<uintptr_t>(data) & 1;
+
+    for (int f = 0; f <= maxFile; ++f)
+        for (int i = 0; i < sides; ++i)
+            data = setSizes(e.get(i, f), data);
+
+    if (e.isDtz) data = setDtzMap(e, data, maxFile);
+
+    for (int f = 0; f <= maxFile; ++f) {
+        for (int i = 0; i < sides; ++i) {
+            PairsData* d = e.get(i, f);
+            d->sparseIndex = data;
+            data += d->sparseIndexSize * 6;
+        }
+    }
+
+    for (int f = 0; f <= maxFile; ++f) {
+        for (int i = 0; i < sides; ++i) {
+            PairsData* d = e.get(i, f);
+            d->blockLength = data;
+            data += d->blockLengthSize * 2;
+        }
+    }
+
+    for (int f = 0; f <= maxFile; ++f) {
+        for (int i = 0; i < sides; ++i) {
+            data = reinterpret_cast<const uint8_t*>((reinterpret_cast<uintptr_t>(data) + 0x3F) & ~uintptr_t(0x3F));
+            PairsData* d = e.get(i, f);
+            d->data = data;
+            data += d->numBlocks * d->blockSize;
+        }
+    }
+}
+
+// Файл отображается при первом обращении; потокобезопасно
+static bool ensureMapped(TbTable& e) {
+    if (e.ready.load(std::memory_order_acquire)) return e.baseAddress != nullptr;
+
+    std::lock_guard<std::mutex> lock(tbMapMutex);
+    if (e.ready.load(std::memory_order_relaxed)) return e.baseAddress != nullptr;
+
+    std::string path = findTableFile(e.name + (e.isDtz ? ".rtbz" : ".rtbw"));
+    const uint8_t* data = path.empty() ? nullptr : mapTableFile(path, e);
+    if (data) initTable(e, data);
+
+    e.ready.store(true, std::memory_order_release);
+    return e.baseAddress != nullptr;
+}
+
+// --- Декодирование ---
+
+static int decompressPairs(const PairsData* d, uint64_t idx) {
+    if (d->flags & TB_SINGLE_VALUE) return d->minSymLen;
+
+    // Разреженный индекс: запись k указывает блок и смещение значения k * span + span / 2
+    uint32_t k = static_cast<uint32_t>(idx / d->span);
+    const uint8_t* sparse = d->sparseIndex + 6 * size_t(k);
+    uint32_t block = readLe32(sparse);
+    int offset = readLe16(sparse + 4);
+    offset += static_cast<int>(idx % d->span) - static_cast<int>(d->span / 2);
+
+    // Сдвигаемся по блокам, пока смещение не попадёт в блок
+    while (offset < 0) {
+        offset += readLe16(d->blockLength + 2 * size_t(--block)) + 1;
+    }
+    while (offset > readLe16(d->blockLength + 2 * size_t(block))) {
+        offset -= readLe16(d->blockLength + 2 * size_t(block++)) + 1;
+    }
+
+    const uint8_t* ptr = d->data + uint64_t(block) * d->blockSize;
+    uint64_t buf64 = readBe64(ptr);
+    ptr += 8;
+    int buf64Size = 64;
+    int sym;
+
+    while (true) {
+        int len = 0; // длина символа минус minSymLen
+        while (buf64 < d->base64[len]) ++len;
+
+        sym = static_cast<int>((buf64 - d->base64[len]) >> (64 - len - d->minSymLen));
+        sym += readLe16(d->lowestSym + 2 * len);
+
+        if (offset < d->symlen[sym] + 1) break;
+
+        offset -= d->symlen[sym] + 1;
+        len += d->minSymLen;
+        buf64 <<= len;
+        buf64Size -= len;
+
+        if (buf64Size <= 32) {
+            buf64Size += 32;
+            buf64 |= uint64_t(readBe32(ptr)) << (64 - buf64Size);
+            ptr += 4;
+        }
+    }
+
+    // Раскрываем пары символов, пока не дойдём до листа
+    while (d->symlen[sym]) {
+        int left = btreeLeft(d, sym);
+        if (offset < d->symlen[left] + 1) {
+            sym = left;
+        } else {
+            offset -= d->symlen[left] + 1;
+            sym = btreeRight(d, sym);
+        }
+    }
+
+    return btreeLeft(d, sym);
+}
+
+static bool checkDtzStm(TbTable& e, int stm, int f) {
+    int flags = e.get(stm, f)->flags;
+    return (flags & TB_STM) == stm || (e.key == e.key2 && !e.hasPawns);
+}
+
+// DTZ хранится в виде частотных рангов; карта восстанавливает исходные значения
+static int mapDtzScore(TbTable& e, int f, int value, WdlScore wdl) {
+    static const int WDL_MAP[] = {1, 3, 0, 2, 0};
+
+    const PairsData* d = e.get(0, f);
+    int w = static_cast<int>(wdl);
+    if (d->flags & TB_MAPPED) {
+        size_t i = size_t(d->mapIdx[WDL_MAP[w + 2]]) + value;
+        value = (d->flags & TB_WIDE) ? readLe16(e.map + 2 * i) : e.map[i];
+    }
+
+    // Таблица может хранить DTZ в ходах — переводим в полуходы
+    if ((wdl == WdlScore::Win && !(d->flags & TB_WIN_PLIES)) ||
+        (wdl == WdlScore::Loss && !(d->flags & TB_LOSS_PLIES)) ||
+        wdl == WdlScore::CursedWin || wdl == WdlScore::BlessedLoss) {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+// Индекс позиции в таблице и значение по нему
+static int probeTable(const TbPosition& pos, TbTable& e, WdlScore wdl, ProbeState& state) {
+    int squares[TB_PIECES];
+    int pieces[TB_PIECES];
+    int size = 0;
+    int leadPawnsCnt = 0;
+    uint64_t leadPawns = 0;
+    int tbFile = 0;
+    uint64_t idx;
+
+    // Таблица хранит позиции с «сильной» стороной за белых; иначе и при
+    // симметричном материале с ходом чёрных меняем цвета и отражаем доску
+    bool symmetricBlackToMove = (e.key == e.key2 && pos.blackToMove);
+    bool blackStronger = (pos.materialKey != e.key);
+    bool flip = symmetricBlackToMove || blackStronger;
+    int flipColor = flip ? 8 : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = (flip ? 1 : 0) ^ (pos.blackToMove ? 1 : 0);
+
+    // С пешками таблица разбита по вертикали ведущей пешки (a..d)
+    if (e.hasPawns) {
+        int pc = e.get(0, 0)->pieces[0] ^ flipColor;
+        for (int sq = 0; sq < 64; ++sq) {
+            if (pos.pieceOn[sq] == pc) {
+                leadPawns |= uint64_t(1) << sq;
+                squares[size++] = sq ^ flipSquares;
+            }
+        }
+        leadPawnsCnt = size;
+        std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCnt, pawnsComp));
+        tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+    }
+
+    if (e.isDtz && !checkDtzStm(e, stm, tbFile)) {
+        state = PROBE_CHANGE_STM;
+        return 0;
+    }
+
+    for (int sq = 0; sq < 64; ++sq) {
+        if (pos.pieceOn[sq] && !(leadPawns & (uint64_t(1) << sq))) {
+            squares[size] = sq ^ flipSquares;
+            pieces[size++] = pos.pieceOn[sq] ^ flipColor;
+        }
+    }
+
+    PairsData* d = e.get(stm, tbFile);
+
+    // Переставляем фигуры в порядке, заданном таблицей
+    for (int i = leadPawnsCnt; i < size - 1; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+            if (d->pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+
+    // Ведущая фигура — на вертикалях a-d
+    if (fileOf(squares[0]) > 3) {
+        for (int i = 0; i < size; ++i) squares[i] = flipFile(squares[i]);
+    }
+
+    if (e.hasPawns) {
+        idx = LEAD_PAWN_IDX[leadPawnsCnt][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawnsCnt, pawnsComp);
+        for (int i = 1; i < leadPawnsCnt; ++i) {
+            idx += BINOMIAL[i][MAP_PAWNS[squares[i]]];
+        }
+    } else {
+        // Без пешек: ведущая фигура ниже 5-й горизонтали...
+        if (rankOf(squares[0]) > 3) {
+            for (int i = 0; i < size; ++i) squares[i] = flipRank(squares[i]);
+        }
+
+        // ...и первая фигура ведущей группы вне диагонали a1-h8 — под ней
+        for (int i = 0; i < d->groupLen[0]; ++i) {
+            if (!offA1H8(squares[i])) continue;
+            if (offA1H8(squares[i]) > 0) {
+                for (int j = i; j < size; ++j) {
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+            }
+            break;
+        }
+
+        if (e.hasUniquePieces) {
+            int adjust1 = (squares[1] > squares[0]);
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+            if (offA1H8(squares[0])) {
+                idx = (MAP_A1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 +
+                      squares[2] - adjust2;
+            } else if (offA1H8(squares[1])) {
+                idx = (6 * 63 + rankOf(squares[0]) * 28 + MAP_B1H1H7[squares[1]]) * 62 +
+                      squares[2] - adjust2;
+            } else if (offA1H8(squares[2])) {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 +
+                      rankOf(squares[0]) * 7 * 28 +
+                      (rankOf(squares[1]) - adjust1) * 28 +
+                      MAP_B1H1H7[squares[2]];
+            } else {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 +
+                      rankOf(squares[0]) * 7 * 6 +
+                      (rankOf(squares[1]) - adjust1) * 6 +
+                      (rankOf(squares[2]) - adjust2);
+            }
+        } else {
+            idx = MAP_KK[MAP_A1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // Остальные группы: поля по возрастанию, со сдвигом за занятые предыдущими группами
+    idx *= d->groupIdx[0];
+    int* groupSq = squares + d->groupLen[0];
+    bool remainingPawns = e.hasPawns && e.pawnCount[1];
+
+    for (int next = 1; d->groupLen[next]; ++next) {
+        std::stable_sort(groupSq, groupSq + d->groupLen[next]);
+        uint64_t n = 0;
+        for (int i = 0; i < d->groupLen[next]; ++i) {
+            int adjust = static_cast<int>(std::count_if(squares, groupSq,
+                                                        [&](int s) { return groupSq[i] > s; }));
+            n += BINOMIAL[i + 1][groupSq[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        idx += n * d->groupIdx[next];
+        groupSq += d->groupLen[next];
+    }
+
+    int value = decompressPairs(d, idx);
+    return e.isDtz ? mapDtzScore(e, tbFile, value, wdl) : value - 2;
+}
+
+static TbEntry* findEntry(uint64_t key) {
+    auto it = tbIndex.find(key);
+    return it == tbIndex.end() ? nullptr : &it->second;
+}
+
+static WdlScore probeWdlTable(const Board& board, Color stm, ProbeState& state) {
+    TbPosition pos = makeTbPosition(board, stm);
+    if (pos.pieceCount == 2) return WdlScore::Draw; // KvK
+
+    TbEntry* entry = findEntry(pos.materialKey);
+    if (!entry || !ensureMapped(*entry->wdl)) {
+        state = PROBE_FAIL;
+        return WdlScore::Draw;
+    }
+    return static_cast<WdlScore>(probeTable(pos, *entry->wdl, WdlScore::Draw, state));
+}
+
+static int probeDtzTable(const Board& board, Color stm, WdlScore wdl, ProbeState& state) {
+    TbPosition pos = makeTbPosition(board, stm);
+    TbEntry* entry = findEntry(pos.materialKey);
+    if (!entry || !ensureMapped(*entry->dtz)) {
+        state = PROBE_FAIL;
+        return 0;
+    }
+    return probeTable(pos, *entry->dtz, wdl, state);
+}
+
+// --- Пробы с учётом взятий ---
+
+static WdlScore negate(WdlScore w) {
+    return static_cast<WdlScore>(-static_cast<int>(w));
+}
+
+static bool isZeroingCapture(const Board& board, const Move& move) {
+    if (board.getPiece(move.to)) return true;
+    const Piece* piece = board.getPiece(move.from);
+    return piece && piece->type == PieceType::Pawn && move.from.col != move.to.col; // en passant
+}
+
+// Таблицы не хранят точных значений там, где у стороны хода есть выигрывающее
+// взятие, и вообще не содержат позиций с правом en passant. Поэтому сначала
+// перебираем взятия (а для DTZ — и ходы пешками), затем пробуем саму позицию.
+static WdlScore searchWdl(const Board& board, Color stm, bool checkZeroingMoves, ProbeState& state) {
+    WdlScore bestValue = WdlScore::Loss;
+    std::vector<Move> moves = board.getLegalMoves(stm);
+    size_t moveCount = 0;
+
+    for (const auto& move : moves) {
+        bool capture = isZeroingCapture(board, move);
+        bool pawnMove = board.getPiece(move.from)->type == PieceType::Pawn;
+        if (!capture && (!checkZeroingMoves || !pawnMove)) continue;
+
+        moveCount++;
+        Board next = board.copyForTest();
+        next.makeMove(move);
+        WdlScore value = negate(searchWdl(next, oppositeColor(stm), false, state));
+        if (state == PROBE_FAIL) return WdlScore::Draw;
+
+        if (value > bestValue) {
+            bestValue = value;
+            if (value >= WdlScore::Win) {
+                state = PROBE_ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+
+    // Если перебрали все ходы, значение таблицы не нужно (оно может быть неверным)
+    bool noMoreMoves = moveCount && moveCount == moves.size();
+    WdlScore value;
+    if (noMoreMoves) {
+        value = bestValue;
+    } else {
+        value = probeWdlTable(board, stm, state);
+        if (state == PROBE_FAIL) return WdlScore::Draw;
+    }
+
+    if (bestValue >= value) {
+        state = (bestValue > WdlScore::Draw || noMoreMoves) ? PROBE_ZEROING_BEST_MOVE : PROBE_OK;
+        return bestValue;
+    }
+    state = PROBE_OK;
+    return value;
+}
+
+// DTZ хода, обнуляющего счётчик, восстанавливается по WDL позиции
+static int dtzBeforeZeroing(WdlScore wdl) {
+    switch (wdl) {
+        case WdlScore::Win:         return 1;
+        case WdlScore::CursedWin:   return 101;
+        case WdlScore::BlessedLoss: return -101;
+        case WdlScore::Loss:        return -1;
+        default:                    return 0;
+    }
+}
+
+static int signOf(int v) {
+    return (0 < v) - (v < 0);
+}
+
+static int probeDtzImpl(const Board& board, Color stm, ProbeState& state) {
+    state = PROBE_OK;
+    WdlScore wdl = searchWdl(board, stm, true, state);
+
+    if (state == PROBE_FAIL || wdl == WdlScore::Draw) return 0;
+    if (state == PROBE_ZEROING_BEST_MOVE) return dtzBeforeZeroing(wdl);
+
+    int dtz = probeDtzTable(board, stm, wdl, state);
+    if (state == PROBE_FAIL) return 0;
+
+    if (state != PROBE_CHANGE_STM) {
+        bool cursed = (wdl == WdlScore::BlessedLoss || wdl == WdlScore::CursedWin);
+        return (dtz + 100 * cursed) * signOf(static_cast<int>(wdl));
+    }
+
+    // DTZ хранится для другой стороны — поиск на 1 полуход
+    int minDtz = 0xFFFF;
+    for (const auto& move : board.getLegalMoves(stm)) {
+        bool zeroing = isZeroingCapture(board, move) ||
+                       board.getPiece(move.from)->type == PieceType::Pawn;
+
+        Board next = board.copyForTest();
+        next.makeMove(move);
+        Color them = oppositeColor(stm);
+
+        if (zeroing) {
+            ProbeState s = PROBE_OK;
+            dtz = -dtzBeforeZeroing(searchWdl(next, them, false, s));
+            if (s == PROBE_FAIL) state = PROBE_FAIL;
+        } else {
+            dtz = -probeDtzImpl(next, them, state);
+        }
+
+        // Матующий ход
+        if (dtz == 1 && next.isInCheck(them) && next.getLegalMoves(them).empty()) {
+            minDtz = 1;
+        }
+
+        if (!zeroing) dtz += signOf(dtz);
+
+        if (dtz < minDtz && signOf(dtz) == signOf(static_cast<int>(wdl))) {
+            minDtz = dtz;
+        }
+
+        if (state == PROBE_FAIL) return 0;
+    }
+
+    return minDtz == 0xFFFF ? -1 : minDtz;
+}
+
+// --- Публичный интерфейс ---
+
+static bool registerTable(const std::string& name) {
+    auto v = name.find('v');
+    if (v == std::string::npos) return false;
+    std::string sides[2] = {name.substr(0, v), name.substr(v + 1)};
+
+    int counts[2][7] = {};
+    int pieceCount = 0;
+    for (int c = 0; c < 2; ++c) {
+        if (sides[c].empty() || sides[c][0] != 'K') return false;
+        for (char ch : sides[c]) {
+            int t = tbTypeFromChar(ch);
+            if (!t) return false;
+            counts[c][t]++;
+            pieceCount++;
+        }
+        if (counts[c][6] != 1) return false;
+    }
+    if (pieceCount > TB_PIECES) return false;
+
+    int swapped[2][7];
+    for (int t = 0; t < 7; ++t) {
+        swapped[0][t] = counts[1][t];
+        swapped[1][t] = counts[0][t];
+    }
+
+    auto wdl = std::make_unique<TbTable>();
+    wdl->name = name;
+    wdl->key = materialKey(counts);
+    wdl->key2 = materialKey(swapped);
+    if (tbIndex.count(wdl->key)) return false; // уже найдена в другом каталоге
+
+    wdl->pieceCount = pieceCount;
+    wdl->hasPawns = counts[0][1] || counts[1][1];
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 1; t <= 5; ++t) {
+            if (counts[c][t] == 1) wdl->hasUniquePieces = true;
+        }
+    }
+
+    // Ведущий цвет — с меньшим числом пешек (лучше сжимается)
+    bool whiteLeads = !counts[1][1] || (counts[0][1] && counts[1][1] >= counts[0][1]);
+    wdl->pawnCount[0] = static_cast<uint8_t>(whiteLeads ? counts[0][1] : counts[1][1]);
+    wdl->pawnCount[1] = static_cast<uint8_t>(whiteLeads ? counts[1][1] : counts[0][1]);
+
+    auto dtz = std::make_unique<TbTable>();
+    dtz->isDtz = true;
+    dtz->name = wdl->name;
+    dtz->key = wdl->key;
+    dtz->key2 = wdl->key2;
+    dtz->pieceCount = wdl->pieceCount;
+    dtz->hasPawns = wdl->hasPawns;
+    dtz->hasUniquePieces = wdl->hasUniquePieces;
+    dtz->pawnCount[0] = wdl->pawnCount[0];
+    dtz->pawnCount[1] = wdl->pawnCount[1];
+
+    TbEntry entry{wdl.get(), dtz.get()};
+    tbIndex[wdl->key] = entry;
+    tbIndex[wdl->key2] = entry;
+    tbMaxPieces = std::max(tbMaxPieces, pieceCount);
+
+    tbTables.push_back(std::move(wdl));
+    tbTables.push_back(std::move(dtz));
+    return true;
+}
+
+int initTablebases(const std::string& paths) {
+    static std::once_flag indexTablesInit;
+    std::call_once(indexTablesInit, initIndexTables);
+
+    tbIndex.clear();
+    tbTables.clear();
+    tbPaths.clear();
+    tbMaxPieces = 0;
+
+    std::istringstream ss(paths);
+    std::string dir;
+    while (std::getline(ss, dir, ':')) {
+        if (!dir.empty()) tbPaths.push_back(dir);
+    }
+
+    int found = 0;
+    for (const auto& path : tbPaths) {
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(path, ec)) {
+            if (file.path().extension() != ".rtbw") continue;
+            if (registerTable(file.path().stem().string())) found++;
+        }
+    }
+    return found;
+}
+
+int tablebaseMaxPieces() {
+    return tbMaxPieces;
+}
+
+void setTablebaseConfig(const TablebaseConfig& config) {
+    tbConfig = config;
+}
+
+const TablebaseConfig& getTablebaseConfig() {
+    return tbConfig;
+}
+
+bool canProbeTablebases(const Board& board) {
+    int limit = std::min(tbConfig.pieceLimit, tbMaxPieces);
+    return board.getPieceCount() <= limit &&
+           !board.canCastleKingside(Color::White) && !board.canCastleQueenside(Color::White) &&
+           !board.canCastleKingside(Color::Black) && !board.canCastleQueenside(Color::Black);
+}
+
+std::optional<WdlScore> probeWdl(const Board& board, Color sideToMove) {
+    ProbeState state = PROBE_OK;
+    WdlScore wdl = searchWdl(board, sideToMove, false, state);
+    if (state == PROBE_FAIL) return std::nullopt;
+    return wdl;
+}
+
+std::optional<int> probeDtz(const Board& board, Color sideToMove) {
+    ProbeState state = PROBE_OK;
+    int dtz = probeDtzImpl(board, sideToMove, state);
+    if (state == PROBE_FAIL) return std::nullopt;
+    return dtz;
+}
+
+std::vector<RootTablebaseMove> probeRootDtz(const Board& board, Color sideToMove) {
+    std::vector<RootTablebaseMove> result;
+    int cnt50 = board.getHalfmoveClock();
+    Color them = oppositeColor(sideToMove);
+
+    for (const auto& move : board.getLegalMoves(sideToMove)) {
+        Board next = board.copyForTest();
+        next.makeMove(move);
+
+        int dtz;
+        if (next.getHalfmoveClock() == 0) {
+            // Обнуляющий ход: dtz одно из -101/-1/0/1/101
+            auto wdl = probeWdl(next, them);
+            if (!wdl) return {};
+            dtz = dtzBeforeZeroing(negate(*wdl));
+        } else {
+            auto d = probeDtz(next, them);
+            if (!d) return {};
+            dtz = -*d;
+            dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+        }
+
+        // Матующему ходу — dtz 1
+        if (dtz == 2 && next.isInCheck(them) && next.getLegalMoves(them).empty()) {
+            dtz = 1;
+        }
+
+        // Гарантированные выигрыши равноценны; проигрыши тоже, пока ничья
+        // по правилу 50 ходов недостижима
+        int rank = dtz > 0 ? (dtz + cnt50 <= 99 ? MAX_DTZ : MAX_DTZ - (dtz + cnt50))
+                 : dtz < 0 ? (-dtz * 2 + cnt50 < 100 ? -MAX_DTZ : -MAX_DTZ + (-dtz + cnt50))
+                 : 0;
+        WdlScore wdl = rank == MAX_DTZ ? WdlScore::Win
+                     : rank > 0 ? WdlScore::CursedWin
+                     : rank == -MAX_DTZ ? WdlScore::Loss
+                     : rank < 0 ? WdlScore::BlessedLoss
+                     : WdlScore::Draw;
+        result.push_back({move, dtz, rank, wdl});
+    }
+    return result;
+}
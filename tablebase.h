@@ -0,0 +1,60 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "board.h"
+#include "move.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+// Эндшпильные таблицы Syzygy (.rtbw — WDL, .rtbz — DTZ).
+// Файлы отображаются в память при первом обращении к таблице.
+
+// Результат WDL с точки зрения стороны хода.
+// Cursed/Blessed — выигрыш/проигрыш, который правило 50 ходов превращает в ничью.
+enum class WdlScore { Loss = -2, BlessedLoss = -1, Draw = 0, CursedWin = 1, Win = 2 };
+
+// Настройки использования таблиц в поиске
+struct TablebaseConfig {
+    int probeDepth = 1;  // минимальная оставшаяся глубина для WDL-проб внутри поиска
+    int pieceLimit = 7;  // максимум фигур на доске (с королями) для проб
+};
+
+// Поиск таблиц в каталогах, перечисленных через ':'.
+// Возвращает число найденных WDL-таблиц. Не потокобезопасно — вызывать до поиска.
+int initTablebases(const std::string& paths);
+
+// Наибольшее число фигур среди найденных таблиц (0 — таблиц нет)
+int tablebaseMaxPieces();
+
+void setTablebaseConfig(const TablebaseConfig& config);
+const TablebaseConfig& getTablebaseConfig();
+
+// Можно ли пробовать позицию: хватает фигур и нет прав рокировки
+bool canProbeTablebases(const Board& board);
+
+// WDL-проба; nullopt — таблица недоступна
+std::optional<WdlScore> probeWdl(const Board& board, Color sideToMove);
+
+// DTZ-проба в полуходах с точки зрения стороны хода; nullopt — таблица недоступна.
+//   n < -100        : проигрыш, но ничья по правилу 50 ходов
+//   -100 <= n <= -1 : проигрыш, n полуходов до обнуляющего хода (-1 — мат)
+//   0               : ничья
+//   1 <= n <= 100   : выигрыш, n полуходов до обнуляющего хода
+//   n > 100         : выигрыш, но ничья по правилу 50 ходов
+// Значение может быть на 1 полуход больше точного.
+std::optional<int> probeDtz(const Board& board, Color sideToMove);
+
+// Корневой ход с оценкой по DTZ
+struct RootTablebaseMove {
+    Move move;
+    int dtz;   // DTZ после хода, считая от корня
+    int rank;  // больше — лучше; одинаковый rank у гарантированных выигрышей
+    WdlScore wdl; // итог хода для стороны корня с учётом счётчика 50 ходов
+};
+
+// Оценка всех легальных ходов корня по DTZ (с учётом счётчика 50 ходов).
+// Пустой вектор — таблицы недоступны.
+std::vector<RootTablebaseMove> probeRootDtz(const Board& board, Color sideToMove);
+
+#endif
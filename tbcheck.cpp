@@ -0,0 +1,195 @@
+#include "tbcheck.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Эталон: WDL и DTZ с точки зрения стороны хода
+struct TablebaseReference {
+    const char* fen;
+    WdlScore wdl;
+    int dtz;
+};
+
+static const TablebaseReference REFERENCES[] = {
+    {"k7/8/1K6/8/8/8/7Q/8 w - - 0 1", WdlScore::Win, 1},       // Qh8#
+    {"k7/8/1K6/8/8/8/7Q/8 b - - 0 1", WdlScore::Draw, 0},      // пат
+    {"8/7q/8/8/8/1k6/8/K7 b - - 0 1", WdlScore::Win, 1},       // то же за чёрных: Qh1#
+    {"k7/8/1K6/8/8/8/8/7R w - - 0 1", WdlScore::Win, 1},       // Rh8#
+    {"8/8/8/8/8/8/1k6/R6K b - - 0 1", WdlScore::Draw, 0},      // Kxa1
+    {"8/4P3/8/8/8/8/k7/4K3 w - - 0 1", WdlScore::Win, 1},      // e8=Q обнуляет счётчик
+    {"8/4P3/8/8/8/8/k7/4K3 b - - 0 1", WdlScore::Loss, -2},    // ход чёрных, затем e8=Q
+    {"k7/8/8/8/8/8/P7/K7 w - - 0 1", WdlScore::Draw, 0},       // ладейная пешка, король в углу
+    {"8/8/8/8/8/8/3kP3/7K b - - 0 1", WdlScore::Draw, 0},      // Kxe2
+};
+
+static std::string wdlName(WdlScore wdl) {
+    switch (wdl) {
+        case WdlScore::Loss:        return "проигрыш";
+        case WdlScore::BlessedLoss: return "спасённый проигрыш";
+        case WdlScore::Draw:        return "ничья";
+        case WdlScore::CursedWin:   return "проклятый выигрыш";
+        case WdlScore::Win:         return "выигрыш";
+    }
+    return "?";
+}
+
+static int signOf(int v) {
+    return (v > 0) - (v < 0);
+}
+
+// DTZ может быть на 1 полуход больше точного (см. probeDtz)
+static bool dtzMatches(int got, int expected) {
+    if (signOf(got) != signOf(expected)) return false;
+    int diff = std::abs(got) - std::abs(expected);
+    return diff == 0 || diff == 1;
+}
+
+static bool checkReferences(TablebaseCheckResult& result, std::string& error) {
+    for (const auto& ref : REFERENCES) {
+        Board board;
+        Color side;
+        if (!board.loadFen(ref.fen, side, error)) return false;
+
+        auto wdl = probeWdl(board, side);
+        auto dtz = probeDtz(board, side);
+        if (!wdl || !dtz) {
+            error = std::string("нет таблицы для ") + ref.fen;
+            return false;
+        }
+        if (*wdl != ref.wdl) {
+            error = std::string(ref.fen) + ": WDL " + wdlName(*wdl) + ", ожидалось " + wdlName(ref.wdl);
+            return false;
+        }
+        if (!dtzMatches(*dtz, ref.dtz)) {
+            error = std::string(ref.fen) + ": DTZ " + std::to_string(*dtz) + ", ожидалось " +
+                    std::to_string(ref.dtz);
+            return false;
+        }
+
+        // Лучший ход корня должен сохранять итог позиции
+        if (board.hasLegalMove(side)) {
+            std::vector<RootTablebaseMove> ranked = probeRootDtz(board, side);
+            if (ranked.empty()) {
+                error = std::string("нет таблицы для ходов из ") + ref.fen;
+                return false;
+            }
+            const RootTablebaseMove& best = *std::max_element(ranked.begin(), ranked.end(),
+                [](const RootTablebaseMove& a, const RootTablebaseMove& b) { return a.rank < b.rank; });
+            if (best.wdl != ref.wdl) {
+                error = std::string(ref.fen) + ": лучший ход " + best.move.toString() + " — " +
+                        wdlName(best.wdl) + ", ожидалось " + wdlName(ref.wdl);
+                return false;
+            }
+        }
+        result.references++;
+    }
+    return true;
+}
+
+// WDL позиции по её ходам: мат и пат определяются доской, KvK — ничья,
+// остальное — пробой после хода. terminal — ходов нет.
+static bool wdlBySuccessors(const Board& board, Color side, WdlScore& wdl, bool& terminal,
+                            std::string& error) {
+    std::vector<Move> moves = board.getLegalMoves(side);
+    terminal = moves.empty();
+    if (terminal) {
+        wdl = board.isInCheck(side) ? WdlScore::Loss : WdlScore::Draw;
+        return true;
+    }
+
+    Color them = oppositeColor(side);
+    wdl = WdlScore::Loss;
+    for (const auto& move : moves) {
+        Board next = board.copyForTest();
+        next.makeMove(move);
+        WdlScore value = WdlScore::Draw;
+        if (next.getPieceCount() > 2) {
+            auto probed = probeWdl(next, them);
+            if (!probed) {
+                error = "нет таблицы после хода " + move.toString();
+                return false;
+            }
+            value = *probed;
+        }
+        value = static_cast<WdlScore>(-static_cast<int>(value));
+        if (value > wdl) wdl = value;
+    }
+    return true;
+}
+
+static bool checkPosition(const Board& board, Color side, std::string& error) {
+    auto wdl = probeWdl(board, side);
+    auto dtz = probeDtz(board, side);
+    if (!wdl || !dtz) {
+        error = "нет таблицы";
+        return false;
+    }
+
+    WdlScore expected;
+    bool terminal = false;
+    if (!wdlBySuccessors(board, side, expected, terminal, error)) return false;
+    if (*wdl != expected) {
+        error = "WDL " + wdlName(*wdl) + ", по ходам " + wdlName(expected);
+        return false;
+    }
+    // У мата и пата DTZ не определён — их значение уже сверено по доске
+    if (!terminal && signOf(*dtz) != signOf(static_cast<int>(*wdl))) {
+        error = "DTZ " + std::to_string(*dtz) + " при WDL " + wdlName(*wdl);
+        return false;
+    }
+    return true;
+}
+
+// Все расстановки: два короля и фигура strong цвета owner, обе стороны хода
+static bool checkMaterial(PieceType strong, Color owner, int stride, TablebaseCheckResult& result,
+                          std::string& error) {
+    Color other = oppositeColor(owner);
+    uint64_t counter = 0;
+    for (int ownKing = 0; ownKing < 64; ++ownKing) {
+        for (int otherKing = 0; otherKing < 64; ++otherKing) {
+            if (otherKing == ownKing) continue;
+            for (int sq = 0; sq < 64; ++sq) {
+                if (sq == ownKing || sq == otherKing) continue;
+                if (strong == PieceType::Pawn && (sq < 8 || sq >= 56)) continue;
+
+                BoardSetup setup;
+                setup.squares[ownKing] = static_cast<int8_t>(static_cast<int>(owner) * 6 + static_cast<int>(PieceType::King));
+                setup.squares[otherKing] = static_cast<int8_t>(static_cast<int>(other) * 6 + static_cast<int>(PieceType::King));
+                setup.squares[sq] = static_cast<int8_t>(static_cast<int>(owner) * 6 + static_cast<int>(strong));
+
+                for (Color side : {Color::White, Color::Black}) {
+                    if (counter++ % stride != 0) continue;
+                    setup.sideToMove = side;
+                    Board board;
+                    if (!board.setup(setup, error)) return false;
+                    // Сторона, которая не ходит, не может стоять под шахом
+                    if (board.isInCheck(oppositeColor(side))) continue;
+
+                    std::string positionError;
+                    if (!checkPosition(board, side, positionError)) {
+                        error = board.getPositionKey(side) + ": " + positionError;
+                        return false;
+                    }
+                    result.positions++;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool checkTablebases(int stride, TablebaseCheckResult& result, std::string& error) {
+    result = TablebaseCheckResult{};
+    if (tablebaseMaxPieces() < 3) {
+        error = "таблицы 3 фигур не найдены (--syzygy <каталог>)";
+        return false;
+    }
+    if (!checkReferences(result, error)) return false;
+
+    for (PieceType strong : {PieceType::Queen, PieceType::Rook, PieceType::Pawn}) {
+        for (Color owner : {Color::White, Color::Black}) {
+            if (!checkMaterial(strong, owner, std::max(1, stride), result, error)) return false;
+        }
+    }
+    return true;
+}
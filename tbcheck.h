@@ -0,0 +1,26 @@
+#ifndef TBCHECK_H
+#define TBCHECK_H
+
+#include <cstdint>
+#include <string>
+
+// Сверка декодера Syzygy с файлами таблиц 3 фигур (KQvK, KRvK, KPvK и таблицы
+// превращений KBvK, KNvK); по умолчанию — тестовые таблицы testdata/syzygy,
+// записанные tbgen. Две части:
+//  - эталонные позиции с известными WDL и DTZ (маты в 1 ход, пат, ничьи
+//    со взятием, превращение) и итог лучшего хода корня по probeRootDtz;
+//  - согласованность: WDL каждой позиции равен лучшему из WDL после её ходов,
+//    знак DTZ совпадает с WDL. Ошибка декодирования почти наверняка нарушает
+//    это равенство хоть в одной позиции.
+
+struct TablebaseCheckResult {
+    int references = 0;    // проверено эталонных позиций
+    uint64_t positions = 0; // проверено позиций на согласованность
+};
+
+// Таблицы должны быть загружены initTablebases. Проверяется каждая stride-я
+// легальная позиция каждого материала (1 — все). false и описание первого
+// расхождения в error.
+bool checkTablebases(int stride, TablebaseCheckResult& result, std::string& error);
+
+#endif
@@ -0,0 +1,552 @@
+// Генератор тестовых таблиц Syzygy для трёх фигур: KQvK, KRvK, KBvK, KNvK, KPvK.
+// Ретроградный анализ на своём простом генераторе ходов (без кода движка) и
+// запись .rtbw/.rtbz в формате Syzygy: та же индексация позиций, блоки
+// с каноническим кодом Хаффмана, разреженный индекс. DTZ хранится для хода
+// белых в полуходах. Результат лежит в testdata/syzygy и читается
+// tablebase.cpp в make syzygy-check; пересоздать — make syzygy-fixture.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+// --- Поля и ходы (sq = row * 8 + col, row 0 — первая горизонталь) ---
+
+static int rowOf(int sq) { return sq >> 3; }
+static int colOf(int sq) { return sq & 7; }
+
+static bool adjacent(int a, int b) {
+    return std::abs(rowOf(a) - rowOf(b)) <= 1 && std::abs(colOf(a) - colOf(b)) <= 1;
+}
+
+enum PieceKind { Pawn, Knight, Bishop, Rook, Queen };
+
+static const int KNIGHT_STEPS[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static const int KING_STEPS[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+// Поля, куда фигура kind с поля from ходит или которые бьёт; blockers — занятые поля
+static std::vector<int> pieceTargets(PieceKind kind, int from, uint64_t blockers) {
+    std::vector<int> targets;
+    int r = rowOf(from), c = colOf(from);
+    if (kind == Knight) {
+        for (const auto& s : KNIGHT_STEPS) {
+            int nr = r + s[0], nc = c + s[1];
+            if (nr >= 0 && nr < 8 && nc >= 0 && nc < 8) targets.push_back(nr * 8 + nc);
+        }
+        return targets;
+    }
+    for (int d = 0; d < 8; ++d) {
+        bool diagonal = d % 2 == 1;
+        if ((kind == Rook && diagonal) || (kind == Bishop && !diagonal)) continue;
+        int nr = r + KING_STEPS[d][0], nc = c + KING_STEPS[d][1];
+        while (nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            int sq = nr * 8 + nc;
+            targets.push_back(sq);
+            if (blockers & (uint64_t(1) << sq)) break;
+            nr += KING_STEPS[d][0];
+            nc += KING_STEPS[d][1];
+        }
+    }
+    return targets;
+}
+
+static bool pieceAttacks(PieceKind kind, int from, int target, uint64_t blockers) {
+    if (kind == Pawn) {
+        return rowOf(target) == rowOf(from) + 1 && std::abs(colOf(target) - colOf(from)) == 1;
+    }
+    auto targets = pieceTargets(kind, from, blockers);
+    return std::find(targets.begin(), targets.end(), target) != targets.end();
+}
+
+// --- Позиции таблицы: белые король и фигура против чёрного короля ---
+
+static const int8_t UNKNOWN = -9;
+static const int8_t LOSS = -2, DRAW = 0, WIN = 2;
+
+static int posIndex(int wk, int bk, int x, int stm) {
+    return ((wk * 64 + bk) * 64 + x) * 2 + stm;
+}
+
+struct Child {
+    int index;      // posIndex в этой таблице или в таблице превращения
+    int8_t promo;   // -1 — эта таблица, иначе PieceKind превращения
+    bool zeroing;   // ход пешкой
+};
+
+struct Solved {
+    PieceKind kind;
+    std::vector<int8_t> wdl; // с точки зрения стороны хода
+    std::vector<int16_t> dtz; // полуходы до мата или обнуляющего хода; -1 — нет
+    std::vector<bool> legal;
+};
+
+static bool legalPosition(PieceKind kind, int wk, int bk, int x, int stm) {
+    if (wk == bk || wk == x || bk == x || adjacent(wk, bk)) return false;
+    if (kind == Pawn && (rowOf(x) == 0 || rowOf(x) == 7)) return false;
+    // Чёрный король под шахом только при своём ходе
+    if (stm == 0 && pieceAttacks(kind, x, bk, uint64_t(1) << wk)) return false;
+    return true;
+}
+
+static void solve(Solved& t, const std::map<PieceKind, Solved>& promotions) {
+    const int SIZE = 64 * 64 * 64 * 2;
+    t.wdl.assign(SIZE, UNKNOWN);
+    t.dtz.assign(SIZE, -1);
+    t.legal.assign(SIZE, false);
+    std::vector<std::vector<Child>> children(SIZE);
+    std::vector<bool> canCapture(SIZE, false);
+
+    for (int wk = 0; wk < 64; ++wk) {
+        for (int bk = 0; bk < 64; ++bk) {
+            for (int x = 0; x < 64; ++x) {
+                for (int stm = 0; stm < 2; ++stm) {
+                    if (!legalPosition(t.kind, wk, bk, x, stm)) continue;
+                    int p = posIndex(wk, bk, x, stm);
+                    t.legal[p] = true;
+                    auto& list = children[p];
+                    uint64_t occupied = (uint64_t(1) << wk) | (uint64_t(1) << bk) | (uint64_t(1) << x);
+
+                    if (stm == 0) {
+                        for (const auto& s : KING_STEPS) {
+                            int nr = rowOf(wk) + s[0], nc = colOf(wk) + s[1];
+                            if (nr < 0 || nr > 7 || nc < 0 || nc > 7) continue;
+                            int to = nr * 8 + nc;
+                            if (to == x || adjacent(to, bk)) continue;
+                            list.push_back({posIndex(to, bk, x, 1), -1, false});
+                        }
+                        if (t.kind == Pawn) {
+                            int one = x + 8;
+                            if (one != wk && one != bk) {
+                                if (rowOf(one) == 7) {
+                                    for (PieceKind promo : {Queen, Rook, Bishop, Knight}) {
+                                        list.push_back({posIndex(wk, bk, one, 1), static_cast<int8_t>(promo), true});
+                                    }
+                                } else {
+                                    list.push_back({posIndex(wk, bk, one, 1), -1, true});
+                                    int two = x + 16;
+                                    if (rowOf(x) == 1 && two != wk && two != bk) {
+                                        list.push_back({posIndex(wk, bk, two, 1), -1, true});
+                                    }
+                                }
+                            }
+                        } else {
+                            for (int to : pieceTargets(t.kind, x, occupied)) {
+                                if (to == wk || to == bk) continue;
+                                list.push_back({posIndex(wk, bk, to, 1), -1, false});
+                            }
+                        }
+                    } else {
+                        // Король чёрных: фигура бьёт сквозь его старое поле
+                        uint64_t withoutKing = (uint64_t(1) << wk) | (uint64_t(1) << x);
+                        for (const auto& s : KING_STEPS) {
+                            int nr = rowOf(bk) + s[0], nc = colOf(bk) + s[1];
+                            if (nr < 0 || nr > 7 || nc < 0 || nc > 7) continue;
+                            int to = nr * 8 + nc;
+                            if (adjacent(to, wk)) continue;
+                            if (to == x) {
+                                canCapture[p] = true; // остаются два короля — ничья
+                                continue;
+                            }
+                            if (pieceAttacks(t.kind, x, to, withoutKing)) continue;
+                            list.push_back({posIndex(wk, to, x, 0), -1, false});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    auto childWdl = [&](const Child& c) {
+        return c.promo < 0 ? t.wdl[c.index] : promotions.at(static_cast<PieceKind>(c.promo)).wdl[c.index];
+    };
+    auto childDtz = [&](const Child& c) {
+        return c.promo < 0 ? t.dtz[c.index] : promotions.at(static_cast<PieceKind>(c.promo)).dtz[c.index];
+    };
+
+    // Маты и паты
+    for (int p = 0; p < SIZE; ++p) {
+        if (!t.legal[p] || p % 2 == 0 || canCapture[p] || !children[p].empty()) continue;
+        int x = (p / 2) % 64, bk = (p / 128) % 64, wk = p / 8192;
+        bool check = pieceAttacks(t.kind, x, bk, uint64_t(1) << wk);
+        t.wdl[p] = check ? LOSS : DRAW;
+        if (check) t.dtz[p] = 0;
+    }
+
+    // WDL: неподвижная точка; всё нерешённое — ничья
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int p = 0; p < SIZE; ++p) {
+            if (!t.legal[p] || t.wdl[p] != UNKNOWN) continue;
+            if (p % 2 == 0) {
+                for (const auto& c : children[p]) {
+                    if (childWdl(c) == LOSS) {
+                        t.wdl[p] = WIN;
+                        changed = true;
+                        break;
+                    }
+                }
+            } else if (!canCapture[p]) {
+                bool allWin = std::all_of(children[p].begin(), children[p].end(),
+                                          [&](const Child& c) { return childWdl(c) == WIN; });
+                if (allWin) {
+                    t.wdl[p] = LOSS;
+                    changed = true;
+                }
+            }
+        }
+    }
+    for (int p = 0; p < SIZE; ++p) {
+        if (t.legal[p] && t.wdl[p] == UNKNOWN) t.wdl[p] = DRAW;
+    }
+
+    // DTZ по уровням: выигрыш за k полуходов — ход пешкой в проигрыш соперника
+    // (k = 1) или ход в его проигрыш за k - 1; проигрыш — самый долгий ответ
+    for (int level = 1;; ++level) {
+        bool pending = false;
+        for (int p = 0; p < SIZE; p += 2) {
+            if (!t.legal[p] || t.wdl[p] != WIN || t.dtz[p] >= 0) continue;
+            for (const auto& c : children[p]) {
+                if (childWdl(c) != LOSS) continue;
+                if ((c.zeroing && level == 1) || (!c.zeroing && childDtz(c) == level - 1)) {
+                    t.dtz[p] = static_cast<int16_t>(level);
+                    break;
+                }
+            }
+            if (t.dtz[p] < 0) pending = true;
+        }
+        for (int p = 1; p < SIZE; p += 2) {
+            if (!t.legal[p] || t.wdl[p] != LOSS || t.dtz[p] >= 0) continue;
+            int longest = -1;
+            bool known = true;
+            for (const auto& c : children[p]) {
+                int d = childDtz(c);
+                if (d < 0) known = false;
+                longest = std::max(longest, d);
+            }
+            if (known) t.dtz[p] = static_cast<int16_t>(longest + 1);
+            else pending = true;
+        }
+        if (!pending) break;
+        if (level > 1000) {
+            std::cerr << "Ошибка: DTZ не сходится\n";
+            std::exit(1);
+        }
+    }
+}
+
+// --- Индексация Syzygy для трёх фигур ---
+
+static int MAP_A1D1D4[64];
+static int MAP_B1H1H7[64];
+
+static int offA1H8(int sq) { return rowOf(sq) - colOf(sq); }
+
+static void initMaps() {
+    int code = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        if (offA1H8(sq) < 0) MAP_B1H1H7[sq] = code++;
+    }
+    std::vector<int> diagonal;
+    code = 0;
+    for (int sq = 0; sq <= 27; ++sq) {
+        if (colOf(sq) > 3) continue;
+        if (offA1H8(sq) < 0) MAP_A1D1D4[sq] = code++;
+        else if (offA1H8(sq) == 0) diagonal.push_back(sq);
+    }
+    for (int sq : diagonal) MAP_A1D1D4[sq] = code++;
+}
+
+static const uint64_t UNIQUE3_SIZE = 31332;
+static const uint64_t PAWN_FILE_SIZE = 6 * 63 * 62;
+
+// Три уникальные фигуры без пешек; s — поля в порядке фигур таблицы
+static uint64_t indexUnique3(int s[3]) {
+    if (colOf(s[0]) > 3) for (int i = 0; i < 3; ++i) s[i] ^= 7;
+    if (rowOf(s[0]) > 3) for (int i = 0; i < 3; ++i) s[i] ^= 56;
+    for (int i = 0; i < 3; ++i) {
+        if (!offA1H8(s[i])) continue;
+        if (offA1H8(s[i]) > 0) {
+            for (int j = i; j < 3; ++j) s[j] = ((s[j] >> 3) | (s[j] << 3)) & 63;
+        }
+        break;
+    }
+    int adjust1 = s[1] > s[0];
+    int adjust2 = (s[2] > s[0]) + (s[2] > s[1]);
+    if (offA1H8(s[0])) return (uint64_t(MAP_A1D1D4[s[0]]) * 63 + (s[1] - adjust1)) * 62 + s[2] - adjust2;
+    if (offA1H8(s[1])) return (6 * 63 + uint64_t(rowOf(s[0])) * 28 + MAP_B1H1H7[s[1]]) * 62 + s[2] - adjust2;
+    if (offA1H8(s[2])) {
+        return 6 * 63 * 62 + 4 * 28 * 62 + rowOf(s[0]) * 7 * 28 + (rowOf(s[1]) - adjust1) * 28 +
+               MAP_B1H1H7[s[2]];
+    }
+    return 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rowOf(s[0]) * 7 * 6 + (rowOf(s[1]) - adjust1) * 6 +
+           (rowOf(s[2]) - adjust2);
+}
+
+// Пешка и два короля: вертикаль пешки (a..d) и индекс внутри неё
+static uint64_t indexPawn(int s[3], int& file) {
+    if (colOf(s[0]) > 3) for (int i = 0; i < 3; ++i) s[i] ^= 7;
+    file = colOf(s[0]);
+    uint64_t idx = rowOf(s[0]) - 1;
+    idx += uint64_t(s[1] - (s[0] < s[1])) * 6;
+    idx += uint64_t(s[2] - (s[0] < s[2]) - (s[1] < s[2])) * 6 * 63;
+    return idx;
+}
+
+// --- Сжатие: канонический код Хаффмана по отдельным значениям ---
+
+static void putLe16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+}
+
+static void putLe32(std::vector<uint8_t>& out, uint32_t v) {
+    putLe16(out, v & 0xFFFF);
+    putLe16(out, v >> 16);
+}
+
+struct Packed {
+    std::vector<uint8_t> sizes;  // заголовок подтаблицы (setSizes)
+    std::vector<uint8_t> sparse;
+    std::vector<uint8_t> blockLength;
+    std::vector<uint8_t> data;
+};
+
+static const int BLOCK_SIZE_LOG = 10;
+static const int SPAN_LOG = 10;
+
+static Packed packValues(const std::vector<int>& values, uint8_t flags) {
+    Packed out;
+    std::map<int, uint64_t> freq;
+    for (int v : values) freq[v]++;
+
+    if (freq.size() == 1) {
+        out.sizes.push_back(flags | 128);
+        out.sizes.push_back(static_cast<uint8_t>(values[0]));
+        return out;
+    }
+
+    // Длины кодов Хаффмана
+    std::map<int, int> length;
+    using Node = std::pair<uint64_t, std::vector<int>>;
+    auto cmp = [](const Node& a, const Node& b) { return a.first > b.first; };
+    std::priority_queue<Node, std::vector<Node>, decltype(cmp)> heap(cmp);
+    for (auto [v, f] : freq) heap.push({f, {v}});
+    while (heap.size() > 1) {
+        Node a = heap.top(); heap.pop();
+        Node b = heap.top(); heap.pop();
+        for (int v : a.second) length[v]++;
+        for (int v : b.second) length[v]++;
+        a.second.insert(a.second.end(), b.second.begin(), b.second.end());
+        heap.push({a.first + b.first, a.second});
+    }
+    int minLen = 64, maxLen = 0;
+    for (auto [v, l] : length) {
+        minLen = std::min(minLen, l);
+        maxLen = std::max(maxLen, l);
+    }
+
+    // Символы нумеруются от длинных кодов к коротким; коды длины l идут
+    // подряд от base[l], длинные коды численно меньше
+    std::vector<int> symbols;
+    for (int l = maxLen; l >= minLen; --l) {
+        for (auto [v, len] : length) if (len == l) symbols.push_back(v);
+    }
+    std::vector<uint32_t> lowestSym(maxLen + 2, 0), base(maxLen + 2, 0);
+    uint32_t next = 0;
+    for (int l = maxLen; l >= minLen; --l) {
+        lowestSym[l] = next;
+        for (auto [v, len] : length) if (len == l) next++;
+    }
+    base[maxLen] = 0;
+    for (int l = maxLen - 1; l >= minLen; --l) {
+        base[l] = (base[l + 1] + lowestSym[l] - lowestSym[l + 1]) / 2;
+    }
+    std::map<int, std::pair<uint32_t, int>> code; // значение -> (код, длина)
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        int l = length[symbols[i]];
+        code[symbols[i]] = {base[l] + static_cast<uint32_t>(i) - lowestSym[l], l};
+    }
+
+    out.sizes.push_back(flags);
+    out.sizes.push_back(BLOCK_SIZE_LOG);
+    out.sizes.push_back(SPAN_LOG);
+    out.sizes.push_back(0); // padding
+    size_t numBlocksPos = out.sizes.size();
+    putLe32(out.sizes, 0);
+    out.sizes.push_back(static_cast<uint8_t>(maxLen));
+    out.sizes.push_back(static_cast<uint8_t>(minLen));
+    for (int l = minLen; l <= maxLen; ++l) putLe16(out.sizes, lowestSym[l]);
+    putLe16(out.sizes, static_cast<uint32_t>(symbols.size()));
+    for (int v : symbols) {
+        // Лист: левый — значение, правый — 0xFFF
+        out.sizes.push_back(v & 0xFF);
+        out.sizes.push_back(static_cast<uint8_t>(((v >> 8) & 0xF) | 0xF0));
+        out.sizes.push_back(0xFF);
+    }
+    if (symbols.size() & 1) out.sizes.push_back(0);
+
+    // Блоки: биты от старшего, запас 64 бита на опережающее чтение
+    const size_t blockSize = size_t(1) << BLOCK_SIZE_LOG;
+    const size_t bitBudget = blockSize * 8 - 64;
+    std::vector<uint64_t> blockStart;
+    size_t i = 0;
+    while (i < values.size()) {
+        blockStart.push_back(i);
+        std::vector<uint8_t> block(blockSize, 0);
+        size_t bits = 0, count = 0;
+        while (i < values.size() && count < 65536) {
+            auto [c, l] = code[values[i]];
+            if (bits + l > bitBudget) break;
+            for (int b = l - 1; b >= 0; --b, ++bits) {
+                if ((c >> b) & 1) block[bits / 8] |= static_cast<uint8_t>(0x80 >> (bits % 8));
+            }
+            ++i;
+            ++count;
+        }
+        putLe16(out.blockLength, static_cast<uint32_t>(count - 1));
+        out.data.insert(out.data.end(), block.begin(), block.end());
+    }
+    uint32_t numBlocks = static_cast<uint32_t>(blockStart.size());
+    for (int b = 0; b < 4; ++b) out.sizes[numBlocksPos + b] = (numBlocks >> (8 * b)) & 0xFF;
+
+    // Разреженный индекс: блок и смещение значения k * span + span / 2
+    const uint64_t span = uint64_t(1) << SPAN_LOG;
+    uint64_t entries = (values.size() + span - 1) / span;
+    for (uint64_t k = 0; k < entries; ++k) {
+        uint64_t pos = k * span + span / 2;
+        size_t block = std::upper_bound(blockStart.begin(), blockStart.end(), pos) - blockStart.begin() - 1;
+        putLe32(out.sparse, static_cast<uint32_t>(block));
+        putLe16(out.sparse, static_cast<uint32_t>(pos - blockStart[block]));
+    }
+    return out;
+}
+
+// --- Файлы ---
+
+static const int TB_WIN_PLIES = 4, TB_LOSS_PLIES = 8;
+
+static const char* NAMES[] = {"KPvK", "KNvK", "KBvK", "KRvK", "KQvK"};
+static const int TB_CODE[] = {1, 2, 3, 4, 5}; // тип фигуры Syzygy
+
+// Подтаблицы: [вертикаль][сторона хода] -> значения по индексам
+using SubTables = std::vector<std::vector<std::vector<int>>>;
+
+static void fillValues(const Solved& t, bool dtz, SubTables& tables) {
+    bool pawns = t.kind == Pawn;
+    int files = pawns ? 4 : 1;
+    uint64_t size = pawns ? PAWN_FILE_SIZE : UNIQUE3_SIZE;
+    int sides = dtz ? 1 : 2;
+    tables.assign(files, std::vector<std::vector<int>>(sides, std::vector<int>(size, -1)));
+
+    for (int wk = 0; wk < 64; ++wk) {
+        for (int bk = 0; bk < 64; ++bk) {
+            for (int x = 0; x < 64; ++x) {
+                for (int stm = 0; stm < sides; ++stm) {
+                    int p = posIndex(wk, bk, x, stm);
+                    if (!t.legal[p]) continue;
+                    int value;
+                    if (dtz) value = t.wdl[p] == WIN ? t.dtz[p] - 1 : 0;
+                    else value = t.wdl[p] + 2;
+
+                    // Порядок фигур таблицы: пешка первой, иначе фигура, король, король
+                    int s[3] = {x, wk, bk};
+                    int file = 0;
+                    uint64_t idx = pawns ? indexPawn(s, file) : indexUnique3(s);
+                    int& slot = tables[file][stm][idx];
+                    if (slot >= 0 && slot != value) {
+                        std::cerr << NAMES[t.kind] << ": разные значения у симметричных позиций\n";
+                        std::exit(1);
+                    }
+                    slot = value;
+                }
+            }
+        }
+    }
+
+    // Неиспользуемые индексы — самым частым значением
+    for (auto& byFile : tables) {
+        for (auto& values : byFile) {
+            std::map<int, int> freq;
+            for (int v : values) if (v >= 0) freq[v]++;
+            int common = std::max_element(freq.begin(), freq.end(),
+                [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+            for (int& v : values) if (v < 0) v = common;
+        }
+    }
+}
+
+static bool writeTable(const Solved& t, bool dtz, const std::string& dir) {
+    SubTables tables;
+    fillValues(t, dtz, tables);
+    bool pawns = t.kind == Pawn;
+    int files = static_cast<int>(tables.size());
+    int sides = static_cast<int>(tables[0].size());
+
+    std::vector<uint8_t> out;
+    static const uint8_t MAGIC_WDL[4] = {0x71, 0xE8, 0x23, 0x5D};
+    static const uint8_t MAGIC_DTZ[4] = {0xD7, 0x66, 0x0C, 0xA5};
+    out.insert(out.end(), dtz ? MAGIC_DTZ : MAGIC_WDL, (dtz ? MAGIC_DTZ : MAGIC_WDL) + 4);
+    out.push_back(static_cast<uint8_t>((sides == 2 ? 1 : 0) | (pawns ? 2 : 0)));
+
+    int pieces[3] = {TB_CODE[t.kind], 6, 14};
+    for (int f = 0; f < files; ++f) {
+        out.push_back(0); // ведущая группа кодируется первой для обеих сторон
+        for (int p : pieces) out.push_back(static_cast<uint8_t>(p | (p << 4)));
+    }
+    if (out.size() & 1) out.push_back(0);
+
+    std::vector<std::vector<Packed>> packed(files);
+    for (int f = 0; f < files; ++f) {
+        for (int s = 0; s < sides; ++s) {
+            uint8_t flags = dtz ? (TB_WIN_PLIES | TB_LOSS_PLIES) : 0; // DTZ: ход белых (TB_STM = 0)
+            packed[f].push_back(packValues(tables[f][s], flags));
+            out.insert(out.end(), packed[f][s].sizes.begin(), packed[f][s].sizes.end());
+        }
+    }
+    if (out.size() & 1) out.push_back(0); // карт DTZ нет
+    for (auto& byFile : packed) for (auto& p : byFile) out.insert(out.end(), p.sparse.begin(), p.sparse.end());
+    for (auto& byFile : packed) for (auto& p : byFile) out.insert(out.end(), p.blockLength.begin(), p.blockLength.end());
+    for (auto& byFile : packed) {
+        for (auto& p : byFile) {
+            while (out.size() % 64) out.push_back(0);
+            out.insert(out.end(), p.data.begin(), p.data.end());
+        }
+    }
+    // Размер файла Syzygy: кратен 64 плюс 16 байт контрольной суммы
+    while (out.size() % 64) out.push_back(0);
+    out.insert(out.end(), 16, 0);
+
+    std::string path = dir + "/" + NAMES[t.kind] + (dtz ? ".rtbz" : ".rtbw");
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    if (!file) {
+        std::cerr << "Ошибка: не удалось записать " << path << "\n";
+        return false;
+    }
+    std::cout << path << ": " << out.size() << " байт\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Использование: tbgen <каталог>\n";
+        return 1;
+    }
+    initMaps();
+
+    std::map<PieceKind, Solved> solved;
+    for (PieceKind kind : {Queen, Rook, Bishop, Knight, Pawn}) {
+        Solved t;
+        t.kind = kind;
+        solve(t, solved);
+        if (!writeTable(t, false, argv[1]) || !writeTable(t, true, argv[1])) return 1;
+        solved[kind] = std::move(t);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "threadpool.h"
+#include <algorithm>
+
+// Номер потока пула в текущем потоке (-1 — поток не из пула)
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index = (currentPool == this)
+        ? static_cast<unsigned>(currentWorker)
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % size();
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        pending_++;
+        queued_++;
+    }
+    workAvailable_.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    idle_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()>& task) {
+    // Сначала своя очередь с конца
+    {
+        WorkerQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Затем перехват из чужих с начала, начиная с соседа
+    for (unsigned i = 1; i < size(); ++i) {
+        WorkerQueue& victim = *queues_[(index + i) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentWorker = static_cast<int>(index);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            workAvailable_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) return;
+            queued_--; // резервируем одну задачу — она точно есть в какой-то очереди
+        }
+
+        std::function<void()> task;
+        while (!popTask(index, task)) {
+            std::this_thread::yield(); // обход очередей не атомарен — повторяем
+        }
+        task();
+
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        if (--pending_ == 0) idle_.notify_all();
+    }
+}
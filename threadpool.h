@@ -0,0 +1,68 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом задач (work stealing).
+// У каждого потока своя очередь: свои задачи он берёт с конца (LIFO —
+// свежие данные в кэше), чужие перехватывает с начала (FIFO — самые крупные).
+class ThreadPool {
+public:
+    // threads = 0 — по числу аппаратных потоков
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Поставить задачу. Из потока пула — в его собственную очередь,
+    // извне — по очереди в очереди всех потоков.
+    void submit(std::function<void()> task);
+
+    // Поставить задачу и получить future её результата
+    template <typename F>
+    auto async(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        submit([task]() { (*task)(); });
+        return result;
+    }
+
+    // Дождаться выполнения всех поставленных задач.
+    // Из потока пула не вызывать — поток заблокируется, не выполняя задач.
+    void waitIdle();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::atomic<unsigned> nextQueue_{0};
+
+    // pending_ — поставленные, но не завершённые задачи
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable idle_;
+    size_t pending_ = 0;
+    size_t queued_ = 0;
+    bool stopping_ = false;
+
+    void workerLoop(unsigned index);
+    bool popTask(unsigned index, std::function<void()>& task);
+};
+
+#endif
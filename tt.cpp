@@ -0,0 +1,165 @@
+#include "tt.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static const char PROMOTIONS[] = {'\0', 'q', 'r', 'b', 'n'};
+
+uint16_t encodeMove(const Move& move) {
+    int promo = 0;
+    for (int i = 1; i < 5; ++i) {
+        if (PROMOTIONS[i] == move.promotion) promo = i;
+    }
+    int from = move.from.row * 8 + move.from.col;
+    int to = move.to.row * 8 + move.to.col;
+    return static_cast<uint16_t>(from | (to << 6) | (promo << 12));
+}
+
+Move decodeMove(uint16_t code) {
+    Move move;
+    int from = code & 63;
+    int to = (code >> 6) & 63;
+    int promo = (code >> 12) & 7;
+    move.from = {from / 8, from % 8};
+    move.to = {to / 8, to % 8};
+    move.promotion = promo < 5 ? PROMOTIONS[promo] : '\0';
+    return move;
+}
+
+static std::atomic<TtPages> ttPages{TtPages::Transparent};
+
+void setTtPages(TtPages pages) {
+    ttPages.store(pages, std::memory_order_relaxed);
+}
+
+static const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+// Меньшие таблицы обнуляются одним потоком: запуск потоков дороже
+static const size_t PARALLEL_CLEAR_BYTES = size_t(32) << 20;
+
+TranspositionTable::TranspositionTable(size_t sizeMb) {
+    // Размер — наибольшая степень двойки корзин, помещающаяся в sizeMb
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= sizeMb * 1024 * 1024) count *= 2;
+    mask_ = count - 1;
+    bytes_ = count * sizeof(Bucket);
+
+    TtPages pages = ttPages.load(std::memory_order_relaxed);
+    void* memory = nullptr;
+#ifdef __linux__
+    if (pages == TtPages::Explicit && bytes_ >= HUGE_PAGE_SIZE) {
+        memory = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+        } else {
+            mapped_ = true;
+        }
+    }
+#endif
+    if (!memory) {
+        // Выравнивание по большой странице, чтобы ядро могло отобразить таблицу ими целиком
+        size_t alignment = bytes_ >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(Bucket);
+        memory = std::aligned_alloc(alignment, bytes_);
+        if (!memory) throw std::bad_alloc();
+#ifdef __linux__
+        if (pages != TtPages::Normal && bytes_ >= HUGE_PAGE_SIZE) madvise(memory, bytes_, MADV_HUGEPAGE);
+#endif
+    }
+    buckets_ = static_cast<Bucket*>(memory);
+    clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+#ifdef __linux__
+    if (mapped_) {
+        munmap(buckets_, bytes_);
+        return;
+    }
+#endif
+    std::free(buckets_);
+}
+
+std::optional<TTEntry> TranspositionTable::probe(uint64_t hash) const {
+    const Bucket& bucket = buckets_[hash & mask_];
+    for (const Entry& e : bucket.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t key = e.key.load(std::memory_order_relaxed);
+        if ((key ^ data) != hash) continue;
+
+        auto bound = static_cast<TTBound>(data & 3);
+        if (bound == TTBound::None) return std::nullopt;
+
+        TTEntry entry;
+        entry.bound = bound;
+        entry.depth = static_cast<int>((data >> 8) & 0xFF);
+        uint16_t move = static_cast<uint16_t>((data >> 16) & 0xFFFF);
+        if (move) entry.move = decodeMove(move);
+        entry.score = static_cast<int32_t>(static_cast<uint32_t>(data >> 32));
+        return entry;
+    }
+    return std::nullopt;
+}
+
+void TranspositionTable::store(uint64_t hash, int depth, int score, TTBound bound,
+                               const std::optional<Move>& move) {
+    Bucket& bucket = buckets_[hash & mask_];
+    unsigned age = age_.load(std::memory_order_relaxed) & 63;
+
+    // Та же позиция — на её место; иначе вытесняем запись прошлых поисков
+    // или с наименьшей глубиной
+    Entry* target = nullptr;
+    uint64_t old = 0;
+    int worst = std::numeric_limits<int>::max();
+    for (Entry& e : bucket.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        if ((e.key.load(std::memory_order_relaxed) ^ data) == hash) {
+            target = &e;
+            old = data;
+            break;
+        }
+        int value = static_cast<int>((data >> 8) & 0xFF);
+        if (((data >> 2) & 63) != age) value -= 256;
+        if (static_cast<TTBound>(data & 3) == TTBound::None) value = -512;
+        if (value < worst) {
+            worst = value;
+            target = &e;
+        }
+    }
+
+    // Запись с лучшим ходом не затираем записью без хода той же позиции
+    uint16_t code = move ? encodeMove(*move) : 0;
+    if (!code && old) code = static_cast<uint16_t>((old >> 16) & 0xFFFF);
+
+    uint64_t data = (uint64_t(static_cast<uint32_t>(score)) << 32) |
+                    (uint64_t(code) << 16) |
+                    (uint64_t(depth & 0xFF) << 8) |
+                    (uint64_t(age) << 2) |
+                    static_cast<uint64_t>(bound);
+    target->key.store(hash ^ data, std::memory_order_relaxed);
+    target->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    // Обнуление заодно впервые касается страниц: в нескольких потоках
+    // отображение памяти ядром тоже идёт параллельно
+    auto* bytes = reinterpret_cast<unsigned char*>(buckets_);
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (bytes_ < PARALLEL_CLEAR_BYTES || threads == 1) {
+        std::memset(bytes, 0, bytes_);
+        return;
+    }
+    size_t chunk = (bytes_ / threads + sizeof(Bucket) - 1) / sizeof(Bucket) * sizeof(Bucket);
+    std::vector<std::thread> workers;
+    for (size_t offset = 0; offset < bytes_; offset += chunk) {
+        size_t size = std::min(chunk, bytes_ - offset);
+        workers.emplace_back([bytes, offset, size]() { std::memset(bytes + offset, 0, size); });
+    }
+    for (auto& worker : workers) worker.join();
+}
@@ -0,0 +1,77 @@
+#ifndef TT_H
+#define TT_H
+
+#include "move.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// Ход в 16 битах: from (6) | to (6) | превращение (3: 0 — нет, 1..4 — q r b n)
+uint16_t encodeMove(const Move& move);
+Move decodeMove(uint16_t code);
+
+// Тип оценки в таблице относительно окна alpha-beta, в котором она получена
+enum class TTBound : uint8_t { None, Exact, Lower, Upper };
+
+struct TTEntry {
+    int score = 0;    // с точки зрения белых
+    int depth = 0;    // оставшаяся глубина, на которой получена оценка
+    TTBound bound = TTBound::None;
+    std::optional<Move> move;
+};
+
+// Страницы памяти под таблицы транспозиций (только Linux; иначе — обычные).
+// Большие страницы уменьшают промахи TLB при случайном доступе к таблице.
+enum class TtPages {
+    Normal,       // обычные страницы
+    Transparent,  // madvise(MADV_HUGEPAGE): ядро подставит большие страницы, если сможет
+    Explicit      // mmap(MAP_HUGETLB) из заранее выделенных; при неудаче — как Transparent
+};
+
+// Для таблиц, создаваемых после вызова; по умолчанию Transparent
+void setTtPages(TtPages pages);
+
+// Таблица транспозиций, общая для последовательных поисков (и потоков).
+// Без блокировок: ключ хранится как hash ^ data, разорванная запись не совпадёт.
+// Записи сгруппированы в корзины по строке кэша: позиция ищется в одной корзине,
+// то есть одним обращением к памяти.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t sizeMb);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    std::optional<TTEntry> probe(uint64_t hash) const;
+    void store(uint64_t hash, int depth, int score, TTBound bound, const std::optional<Move>& move);
+    // Обнулить таблицу (несколькими потоками, если она большая). Не во время поиска.
+    void clear();
+    // Начало нового поиска: записи прошлых поисков вытесняются в первую очередь
+    void newSearch() { age_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Загрузить корзину позиции в кэш заранее (сразу после makeMove)
+    void prefetch(uint64_t hash) const { __builtin_prefetch(&buckets_[hash & mask_]); }
+
+    size_t size() const { return (mask_ + 1) * BUCKET_SIZE; }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data; // score (32) | move (16) | depth (8) | age (6) | bound (2)
+    };
+
+    static constexpr int BUCKET_SIZE = 4;
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+    static_assert(sizeof(Bucket) == 64, "корзина — одна строка кэша");
+
+    Bucket* buckets_ = nullptr;
+    size_t mask_ = 0;
+    size_t bytes_ = 0;
+    bool mapped_ = false; // память от mmap, а не aligned_alloc
+    std::atomic<uint8_t> age_{0};
+};
+
+#endif
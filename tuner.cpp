@@ -0,0 +1,221 @@
+#include "tuner.h"
+#include "ai.h"
+#include "pawns.h"
+#include "record.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <vector>
+
+// Оценка PST линейна по параметрам, поэтому набор хранится один раз как
+// разреженные признаки в плоских массивах:
+// оценка(i) = mgFactor[i] * Σ coef·w.mg + egFactor[i] * Σ coef·w.eg
+struct TuningSet {
+    std::vector<uint32_t> start;   // признаки позиции i — [start[i], start[i + 1])
+    std::vector<uint16_t> index;   // номер параметра в EvalParams
+    std::vector<int8_t> coef;      // белые минус чёрные
+    std::vector<float> mgFactor;
+    std::vector<float> egFactor;
+    std::vector<float> result;     // 1 — победа белых, 0.5 — ничья, 0 — поражение
+
+    size_t size() const { return result.size(); }
+};
+
+static const int MATERIAL_OFFSET = 0;
+static const int PSQT_OFFSET = 6;
+static const int DOUBLED_OFFSET = PSQT_OFFSET + 6 * 64;
+static const int ISOLATED_OFFSET = DOUBLED_OFFSET + 1;
+static const int PASSED_OFFSET = ISOLATED_OFFSET + 1;
+static_assert(PASSED_OFFSET + 8 == EvalParams::COUNT, "порядок параметров как в EvalParams");
+
+// Признаки одной позиции; coefs — рабочий массив размера COUNT, на выходе обнулён
+static void addPosition(const Board& board, float result, std::vector<int>& coefs, TuningSet& set) {
+    std::vector<int> touched;
+    auto add = [&](int index, int value) {
+        if (value == 0) return;
+        if (coefs[index] == 0) touched.push_back(index);
+        coefs[index] += value;
+    };
+
+    for (int sq = 0; sq < 64; ++sq) {
+        const Piece* piece = board.getPiece({sq / 8, sq % 8});
+        if (!piece) continue;
+        int t = static_cast<int>(piece->type);
+        bool white = piece->color == Color::White;
+        add(MATERIAL_OFFSET + t, white ? 1 : -1);
+        add(PSQT_OFFSET + t * 64 + (white ? sq : sq ^ 56), white ? 1 : -1);
+    }
+
+    PawnTerms pawns = countPawnTerms(board);
+    add(DOUBLED_OFFSET, pawns.doubled[1] - pawns.doubled[0]);
+    add(ISOLATED_OFFSET, pawns.isolated[1] - pawns.isolated[0]);
+    for (int r = 0; r < 8; ++r) add(PASSED_OFFSET + r, pawns.passed[0][r] - pawns.passed[1][r]);
+
+    for (int index : touched) {
+        // Совпадения сократились (например, одинаковый материал) — признак не нужен
+        if (coefs[index] != 0) {
+            set.index.push_back(static_cast<uint16_t>(index));
+            set.coef.push_back(static_cast<int8_t>(coefs[index]));
+        }
+        coefs[index] = 0;
+    }
+    set.start.push_back(static_cast<uint32_t>(set.index.size()));
+
+    float phase = std::min(board.getPhase(), MAX_PHASE) / float(MAX_PHASE);
+    set.mgFactor.push_back(phase);
+    set.egFactor.push_back(1 - phase);
+    set.result.push_back(result);
+}
+
+static bool loadTuningSet(const TunerConfig& config, TuningSet& set, std::string& error) {
+    RecordFile file;
+    if (!file.open(config.dataPath, error)) return false;
+    if (file.kind() != RecordKind::Samples) {
+        error = "в файле не обучающие примеры: " + config.dataPath;
+        return false;
+    }
+
+    uint64_t count = file.size();
+    if (config.maxPositions) count = std::min(count, config.maxPositions);
+    set.start.reserve(count + 1);
+    set.start.push_back(0);
+
+    std::vector<int> coefs(EvalParams::COUNT, 0);
+    Board board;
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t size;
+        TrainingSample sample;
+        std::memcpy(&sample, file.record(i, size), sizeof(sample));
+        Color side;
+        if (!unpackPosition(sample.position, board, side, error)) return false;
+        addPosition(board, (sample.result + 1) / 2.0f, coefs, set);
+    }
+    return true;
+}
+
+// Веса в виде массива: [2 * i] — mg, [2 * i + 1] — eg
+static double evaluate(const TuningSet& set, size_t i, const std::vector<double>& w) {
+    double mg = 0, eg = 0;
+    for (uint32_t f = set.start[i]; f < set.start[i + 1]; ++f) {
+        mg += set.coef[f] * w[2 * set.index[f]];
+        eg += set.coef[f] * w[2 * set.index[f] + 1];
+    }
+    return set.mgFactor[i] * mg + set.egFactor[i] * eg;
+}
+
+static double sigmoid(double eval, double k) {
+    return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+}
+
+struct ChunkResult {
+    double error = 0;
+    std::vector<double> gradient;
+};
+
+// Ошибка и (если withGradient) её градиент по весам, параллельно по частям набора
+static ChunkResult computeError(const TuningSet& set, const std::vector<double>& w, double k,
+                                bool withGradient, ThreadPool& pool) {
+    size_t chunks = std::max<size_t>(1, pool.size() * 4);
+    size_t chunkSize = (set.size() + chunks - 1) / chunks;
+
+    std::vector<std::future<ChunkResult>> parts;
+    for (size_t begin = 0; begin < set.size(); begin += chunkSize) {
+        size_t end = std::min(set.size(), begin + chunkSize);
+        parts.push_back(pool.async([&set, &w, k, withGradient, begin, end]() {
+            ChunkResult part;
+            if (withGradient) part.gradient.assign(w.size(), 0.0);
+            for (size_t i = begin; i < end; ++i) {
+                double s = sigmoid(evaluate(set, i, w), k);
+                double diff = s - set.result[i];
+                part.error += diff * diff;
+                if (!withGradient) continue;
+                // d(diff²)/d(оценка) = 2 · diff · s(1 - s) · K · ln10 / 400
+                double g = 2 * diff * s * (1 - s) * k * std::log(10.0) / 400.0;
+                for (uint32_t f = set.start[i]; f < set.start[i + 1]; ++f) {
+                    double c = g * set.coef[f];
+                    part.gradient[2 * set.index[f]] += c * set.mgFactor[i];
+                    part.gradient[2 * set.index[f] + 1] += c * set.egFactor[i];
+                }
+            }
+            return part;
+        }));
+    }
+
+    ChunkResult total;
+    if (withGradient) total.gradient.assign(w.size(), 0.0);
+    for (auto& future : parts) {
+        ChunkResult part = future.get();
+        total.error += part.error;
+        for (size_t j = 0; j < part.gradient.size(); ++j) total.gradient[j] += part.gradient[j];
+    }
+    double n = static_cast<double>(std::max<size_t>(1, set.size()));
+    total.error /= n;
+    for (auto& g : total.gradient) g /= n;
+    return total;
+}
+
+// Масштаб K, при котором текущая оценка лучше всего предсказывает итоги
+// (золотое сечение: ошибка по K унимодальна)
+static double fitScale(const TuningSet& set, const std::vector<double>& w, ThreadPool& pool) {
+    double lo = 0.05, hi = 3.0;
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    for (int i = 0; i < 30; ++i) {
+        double a = hi - ratio * (hi - lo);
+        double b = lo + ratio * (hi - lo);
+        if (computeError(set, w, a, false, pool).error < computeError(set, w, b, false, pool).error) {
+            hi = b;
+        } else {
+            lo = a;
+        }
+    }
+    return (lo + hi) / 2;
+}
+
+bool tuneEvalParams(const TunerConfig& config, ThreadPool& pool, EvalParams& params,
+                    std::string& error) {
+    TuningSet set;
+    if (!loadTuningSet(config, set, error)) return false;
+    if (set.size() == 0) {
+        error = "нет позиций для настройки";
+        return false;
+    }
+    std::cout << "Позиций: " << set.size() << ", признаков: " << set.index.size() << std::endl;
+
+    std::vector<double> w(2 * EvalParams::COUNT);
+    const EvalWeight* weights = params.begin();
+    for (int i = 0; i < EvalParams::COUNT; ++i) {
+        w[2 * i] = weights[i].mg;
+        w[2 * i + 1] = weights[i].eg;
+    }
+
+    double k = fitScale(set, w, pool);
+    std::cout << "K = " << k << ", ошибка: " << computeError(set, w, k, false, pool).error << std::endl;
+
+    // Adam: у параметров очень разная частота признаков (материал пешки — в каждой
+    // позиции, поле h8 ферзя — редко), и обычный спуск с одним шагом для всех
+    // сходится плохо
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> m(w.size(), 0.0), v(w.size(), 0.0);
+    for (int it = 1; it <= config.iterations; ++it) {
+        ChunkResult r = computeError(set, w, k, true, pool);
+        for (size_t j = 0; j < w.size(); ++j) {
+            m[j] = beta1 * m[j] + (1 - beta1) * r.gradient[j];
+            v[j] = beta2 * v[j] + (1 - beta2) * r.gradient[j] * r.gradient[j];
+            double mHat = m[j] / (1 - std::pow(beta1, it));
+            double vHat = v[j] / (1 - std::pow(beta2, it));
+            w[j] -= config.learningRate * mHat / (std::sqrt(vHat) + epsilon);
+        }
+        if (it % 10 == 0 || it == config.iterations) {
+            std::cout << "Шаг " << it << ", ошибка: " << r.error << std::endl;
+        }
+    }
+
+    EvalWeight* out = params.begin();
+    for (int i = 0; i < EvalParams::COUNT; ++i) {
+        out[i].mg = static_cast<int>(std::lround(w[2 * i]));
+        out[i].eg = static_cast<int>(std::lround(w[2 * i + 1]));
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "evalparams.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <string>
+
+// Настройка параметров оценки по методу Texel: минимизация среднеквадратичной
+// ошибки между итогом партии и sigmoid(K * оценка) на наборе позиций.
+
+struct TunerConfig {
+    std::string dataPath;        // обучающие примеры (record.h, TrainingSample)
+    int iterations = 500;        // шагов градиентного спуска
+    double learningRate = 1.0;   // шаг Adam в сантипешках
+    uint64_t maxPositions = 0;   // 0 — все позиции файла
+};
+
+// params — начальная точка и результат. Градиент считается параллельно на пуле.
+bool tuneEvalParams(const TunerConfig& config, ThreadPool& pool, EvalParams& params,
+                    std::string& error);
+
+#endif
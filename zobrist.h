@@ -0,0 +1,43 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "pieces.h"
+#include <cstdint>
+
+// Ключи Zobrist для хеширования позиций.
+// Генерируются на этапе компиляции (splitmix64 с фиксированным зерном),
+// поэтому хеши одинаковы во всех запусках и потоках.
+struct ZobristKeys {
+    uint64_t pieces[2][6][64]; // [цвет][тип фигуры][row * 8 + col]
+    uint64_t castling[4];      // K, Q, k, q
+    uint64_t enPassant[8];     // по вертикали
+    uint64_t side;             // ход чёрных
+};
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys generateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x636865737376697AULL;
+    for (int c = 0; c < 2; ++c)
+        for (int t = 0; t < 6; ++t)
+            for (int sq = 0; sq < 64; ++sq)
+                keys.pieces[c][t][sq] = splitmix64(state);
+    for (int i = 0; i < 4; ++i) keys.castling[i] = splitmix64(state);
+    for (int i = 0; i < 8; ++i) keys.enPassant[i] = splitmix64(state);
+    keys.side = splitmix64(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = generateZobristKeys();
+
+inline uint64_t zobristPieceKey(Color c, PieceType t, int row, int col) {
+    return ZOBRIST.pieces[static_cast<int>(c)][static_cast<int>(t)][row * 8 + col];
+}
+
+#endif